@@ -0,0 +1,100 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "../integer_utils.hpp"
+#include "../concurrent_int_set.hpp"
+
+// Deduplication of 64-bit ids by 1 .. 64 producer threads, every id
+// occurs twice on average, iu::concurrent_int_set vs a mutex protected
+// std::unordered_set.
+
+template<typename Set, typename Insert>
+double run ( const std::vector<std::uint64_t> & ids_, const std::size_t threads_, Set & set_, Insert insert_ ) {
+    std::atomic<std::size_t> inserted { 0 };
+    std::vector<std::thread> pool;
+    const std::size_t chunk = ids_.size ( ) / threads_;
+    const auto start = std::chrono::steady_clock::now ( );
+    for ( std::size_t t = 0; t < threads_; ++t ) {
+        pool.emplace_back ( [ &, t ] ( ) {
+            const std::uint64_t * p = ids_.data ( ) + t * chunk, * e = t == threads_ - 1 ? ids_.data ( ) + ids_.size ( ) : p + chunk;
+            std::size_t n = 0;
+            for ( ; p != e; ++p ) {
+                n += insert_ ( set_, *p );
+            }
+            inserted += n;
+        } );
+    }
+    for ( auto & t : pool ) {
+        t.join ( );
+    }
+    const double s = std::chrono::duration<double> ( std::chrono::steady_clock::now ( ) - start ).count ( );
+    std::printf ( " %10zu", inserted.load ( ) );
+    return s;
+}
+
+auto main ( int argc, char ** argv ) -> int {
+
+    const std::size_t n = argc > 1 ? std::strtoull ( argv [ 1 ], nullptr, 10 ) : std::size_t { 1 } << 23;
+
+    std::vector<std::uint64_t> ids ( n );
+    sax::splitmix64 rng ( 0xBEAC0467EBA5FACB );
+    for ( auto & id : ids ) {
+        id = rng ( ) % ( n / 2 );
+    }
+
+    std::printf ( "%zu ids\n threads   inserted  concurrent Mops   inserted  mutex+unordered_set Mops\n", n );
+
+    for ( std::size_t threads = 1; threads <= 64; threads *= 2 ) {
+        std::printf ( " %7zu", threads );
+        {
+            iu::concurrent_int_set<std::uint64_t> set ( n / 2 );
+            const double s = run ( ids, threads, set, [ ] ( auto & s_, const std::uint64_t id_ ) { return s_.insert ( id_ ) == iu::concurrent_int_set<std::uint64_t>::insert_result::inserted; } );
+            std::printf ( " %16.1f", n / s / 1e6 );
+        }
+        {
+            struct locked_set {
+                std::mutex m_mutex;
+                std::unordered_set<std::uint64_t> m_set;
+            } set;
+            set.m_set.reserve ( n / 2 );
+            const double s = run ( ids, threads, set, [ ] ( auto & s_, const std::uint64_t id_ ) {
+                std::lock_guard<std::mutex> lock ( s_.m_mutex );
+                return s_.m_set.insert ( id_ ).second;
+            } );
+            std::printf ( " %25.1f\n", n / s / 1e6 );
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
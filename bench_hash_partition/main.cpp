@@ -0,0 +1,107 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../integer_utils.hpp"
+#include "../hash_partition.hpp"
+
+// Partitioning of 64-bit keys with 64-bit payloads: a naive two-pass
+// scatter vs iu::hash_partition () with 1 and 2 passes, over a range of
+// fan-outs. Checks the output and reports GB/s of input (keys + payload).
+
+void naive_partition ( const std::uint64_t * keys_, const std::uint64_t * payload_, const std::size_t n_, const unsigned radix_bits_, std::uint64_t * keys_out_, std::uint64_t * payload_out_, std::size_t * offsets_ ) {
+    const std::size_t partitions = std::size_t { 1 } << radix_bits_;
+    std::vector<std::size_t> pos ( partitions + 1 );
+    for ( std::size_t i = 0; i < n_; ++i ) {
+        ++pos [ iu::hash_partition_of ( keys_ [ i ], radix_bits_ ) + 1 ];
+    }
+    for ( std::size_t p = 0; p < partitions; ++p ) {
+        pos [ p + 1 ] += pos [ p ];
+    }
+    std::copy ( pos.begin ( ), pos.end ( ), offsets_ );
+    for ( std::size_t i = 0; i < n_; ++i ) {
+        const std::size_t j = pos [ iu::hash_partition_of ( keys_ [ i ], radix_bits_ ) ]++;
+        keys_out_ [ j ]    = keys_ [ i ];
+        payload_out_ [ j ] = payload_ [ i ];
+    }
+}
+
+bool check ( const std::vector<std::uint64_t> & keys_, const std::vector<std::uint64_t> & keys_out_, const std::vector<std::uint64_t> & payload_out_, const std::vector<std::size_t> & offsets_, const unsigned radix_bits_ ) {
+    std::uint64_t sum = 0;
+    for ( std::size_t p = 0; p + 1 < offsets_.size ( ); ++p ) {
+        for ( std::size_t i = offsets_ [ p ]; i < offsets_ [ p + 1 ]; ++i ) {
+            if ( iu::hash_partition_of ( keys_out_ [ i ], radix_bits_ ) != p || payload_out_ [ i ] != ~keys_out_ [ i ] ) {
+                return false;
+            }
+            sum += keys_out_ [ i ];
+        }
+    }
+    for ( const std::uint64_t k : keys_ ) {
+        sum -= k;
+    }
+    return !sum && offsets_.back ( ) == keys_.size ( );
+}
+
+auto main ( int argc, char ** argv ) -> int {
+
+    const std::size_t n     = argc > 1 ? std::strtoull ( argv [ 1 ], nullptr, 10 ) : std::size_t { 1 } << 25;
+    const unsigned threads  = argc > 2 ? std::atoi ( argv [ 2 ] ) : std::thread::hardware_concurrency ( );
+
+    std::vector<std::uint64_t> keys ( n ), payload ( n ), keys_out ( n ), payload_out ( n );
+    sax::splitmix64 rng ( 0xBEAC0467EBA5FACB );
+    for ( std::size_t i = 0; i < n; ++i ) {
+        keys [ i ]    = rng ( );
+        payload [ i ] = ~keys [ i ];
+    }
+
+    std::printf ( "%zu keys, %u threads, GB/s\n bits      naive   1 pass  2 passes\n", n, threads );
+
+    for ( unsigned bits = 4; bits <= 16; bits += 2 ) {
+        std::vector<std::size_t> offsets ( ( std::size_t { 1 } << bits ) + 1 );
+        std::printf ( " %4u", bits );
+        for ( unsigned method = 0; method < 3; ++method ) {
+            std::fill ( keys_out.begin ( ), keys_out.end ( ), 0 );
+            const auto start = std::chrono::steady_clock::now ( );
+            if ( !method ) {
+                naive_partition ( keys.data ( ), payload.data ( ), n, bits, keys_out.data ( ), payload_out.data ( ), offsets.data ( ) );
+            }
+            else {
+                iu::hash_partition ( keys.data ( ), payload.data ( ), n, bits, threads, keys_out.data ( ), payload_out.data ( ), offsets.data ( ), method );
+            }
+            const double s = std::chrono::duration<double> ( std::chrono::steady_clock::now ( ) - start ).count ( );
+            std::printf ( " %9.2f%s", 16.0 * n / s / 1e9, check ( keys, keys_out, payload_out, offsets, bits ) ? "" : "!" );
+        }
+        std::printf ( "\n" );
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,321 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../integer_utils.hpp"
+
+// Speed and quality of the integer hashes, in the spirit of SMHasher.
+//
+// Speed: latency (ns per hash in a dependent chain), throughput (ns per
+// hash and GB/s of keys over an array) and, where there is one, the AVX2
+// batch version. The fnv1a rows hash the hex form of the key, twice its
+// bytes, their GB/s is of the key all the same.
+//
+// Quality:
+//   avalanche  - flipping input bit i should flip every output bit with
+//                probability 1/2, the RMS and the worst bias over all
+//                ( i, j ) pairs, 2 * | P ( flip ) - 1/2 |;
+//   BIC        - bit independence, flipping input bit i, the flips of
+//                output bits j and k should be uncorrelated, the RMS and
+//                the worst | correlation | over all ( i, j, k );
+//   collisions - of the low and the high half of the output, for
+//                sequential, strided and random keys, against the
+//                expected (birthday) count.
+// The RMS bias of an ideal function is about 1 / sqrt ( samples ), the
+// noise floor is printed along. This is the bias measure used for the
+// constants in integer_utils.hpp, candidate multipliers for iu::hash ()
+// can be given on the command line (hex), they're put through the same
+// tests:
+//
+//     bench_hash_quality [samples] [0xD6E8FEB86659FD93 ...]
+
+template<typename In, typename Out>
+struct function {
+    const char * name;
+    Out ( *f ) ( In );
+};
+
+using function32 = function<std::uint32_t, std::uint32_t>;
+using function64 = function<std::uint64_t, std::uint64_t>;
+
+// The key as a 16 (or 8) character, nul terminated, hex string, on the
+// stack.
+template<typename T>
+struct hex {
+    char s [ 2 * sizeof ( T ) + 1 ];
+    explicit hex ( T x_ ) noexcept {
+        s [ 2 * sizeof ( T ) ] = '\0';
+        for ( std::size_t i = 2 * sizeof ( T ); i--; x_ >>= 4 ) {
+            s [ i ] = "0123456789abcdef" [ x_ & 15 ];
+        }
+    }
+};
+
+std::uint32_t hash32 ( std::uint32_t x_ ) { return iu::hash ( x_ ); }
+// FNV1a of the key, as a 16 (or 8) character hex string.
+std::uint32_t fnv32 ( std::uint32_t x_ ) { return iu::hash_32_fnv1a_const ( hex<std::uint32_t> ( x_ ).s ); }
+std::uint32_t combine32 ( std::uint32_t x_ ) {
+    std::uint32_t seed = 0x811C'9DC5;
+    iu::hash_combine ( seed, x_ );
+    return seed;
+}
+
+std::uint64_t hash64 ( std::uint64_t x_ ) { return iu::hash ( x_ ); }
+std::uint64_t fmix64 ( std::uint64_t x_ ) { return iu::fmix64 ( x_ ); }
+std::uint64_t fnv64 ( std::uint64_t x_ ) { return iu::hash_64_fnv1a_const ( hex<std::uint64_t> ( x_ ).s ); }
+std::uint64_t bytes64 ( std::uint64_t x_ ) { return iu::hash_bytes ( &x_, sizeof ( x_ ) ); }
+std::uint64_t combine64 ( std::uint64_t x_ ) {
+    std::uint64_t seed = 0xCBF2'9CE4'8422'2325;
+    iu::hash_combine ( seed, x_ );
+    return seed;
+}
+
+// iu::hash ( std::uint64_t ) with a candidate multiplier.
+std::uint64_t candidate_multiplier;
+std::uint64_t candidate64 ( std::uint64_t x_ ) {
+    x_ = ( ( x_ >> 32 ) ^ x_ ) * candidate_multiplier;
+    x_ = ( ( x_ >> 32 ) ^ x_ ) * candidate_multiplier;
+    return ( x_ >> 32 ) ^ x_;
+}
+
+// Runs f_ ( thread, samples for the thread ) on all cores.
+template<typename F>
+void parallel ( const std::size_t samples_, F f_ ) {
+    const unsigned threads = std::max ( 1u, std::thread::hardware_concurrency ( ) );
+    std::vector<std::thread> pool;
+    for ( unsigned t = 0; t < threads; ++t ) {
+        pool.emplace_back ( f_, t, samples_ / threads + ( t < samples_ % threads ) );
+    }
+    for ( auto & t : pool ) {
+        t.join ( );
+    }
+}
+
+template<typename In, typename Out>
+void speed ( const function<In, Out> & f_ ) {
+    constexpr std::size_t n = std::size_t { 1 } << 22;
+    std::vector<In> keys ( n );
+    sax::splitmix64 rng ( 0xBEAC0467EBA5FACB );
+    for ( auto & k : keys ) {
+        k = ( In ) rng ( );
+    }
+    auto time = [ ] ( auto && g_ ) {
+        double best = 1e300;
+        for ( int r = 0; r < 3; ++r ) {
+            const auto start = std::chrono::steady_clock::now ( );
+            g_ ( );
+            best = std::min ( best, std::chrono::duration<double> ( std::chrono::steady_clock::now ( ) - start ).count ( ) );
+        }
+        return best;
+    };
+    volatile Out sink;
+    const double latency = time ( [ & ] ( ) {
+        Out h = 0;
+        for ( std::size_t i = 0; i < n; ++i ) {
+            h = f_.f ( ( In ) h ^ keys [ i ] );
+        }
+        sink = h;
+    } );
+    const double throughput = time ( [ & ] ( ) {
+        Out h = 0;
+        for ( std::size_t i = 0; i < n; ++i ) {
+            h ^= f_.f ( keys [ i ] );
+        }
+        sink = h;
+    } );
+    std::printf ( " %-14s %10.2f %10.2f %10.2f", f_.name, latency / n * 1e9, throughput / n * 1e9, n * sizeof ( In ) / throughput / 1e9 );
+}
+
+template<typename In, typename Out>
+void avalanche ( const function<In, Out> & f_, const std::size_t samples_ ) {
+    constexpr int in_bits = 8 * sizeof ( In ), out_bits = 8 * sizeof ( Out );
+    const unsigned threads = std::max ( 1u, std::thread::hardware_concurrency ( ) );
+    std::vector<std::vector<std::uint32_t>> bins ( threads, std::vector<std::uint32_t> ( in_bits * out_bits ) );
+    parallel ( samples_, [ & ] ( const unsigned t_, const std::size_t n_ ) {
+        sax::splitmix64 rng ( 0x0CF3FD1B9997F637 + t_ );
+        std::uint32_t * b = bins [ t_ ].data ( );
+        for ( std::size_t s = 0; s < n_; ++s ) {
+            const In x  = ( In ) rng ( );
+            const Out h = f_.f ( x );
+            for ( int i = 0; i < in_bits; ++i ) {
+                const Out d = h ^ f_.f ( x ^ ( In { 1 } << i ) );
+                for ( int j = 0; j < out_bits; ++j ) {
+                    b [ i * out_bits + j ] += ( d >> j ) & 1;
+                }
+            }
+        }
+    } );
+    double sum = 0.0, worst = 0.0;
+    for ( int k = 0; k < in_bits * out_bits; ++k ) {
+        std::uint64_t c = 0;
+        for ( unsigned t = 0; t < threads; ++t ) {
+            c += bins [ t ] [ k ];
+        }
+        const double bias = std::abs ( 2.0 * c / samples_ - 1.0 );
+        sum += bias * bias;
+        worst = std::max ( worst, bias );
+    }
+    std::printf ( " %10.7f %8.5f", std::sqrt ( sum / ( in_bits * out_bits ) ), worst );
+}
+
+template<typename In, typename Out>
+void bit_independence ( const function<In, Out> & f_, const std::size_t samples_ ) {
+    constexpr int in_bits = 8 * sizeof ( In ), out_bits = 8 * sizeof ( Out );
+    const unsigned threads = std::max ( 1u, std::thread::hardware_concurrency ( ) );
+    // pairs [ i ] [ j ] [ k ] counts the joint flips of output bits j and k for input bit i.
+    std::vector<std::vector<std::uint32_t>> pairs ( threads, std::vector<std::uint32_t> ( in_bits * out_bits * out_bits ) );
+    parallel ( samples_, [ & ] ( const unsigned t_, const std::size_t n_ ) {
+        sax::splitmix64 rng ( 0xAFC1530680179F87 + t_ );
+        std::uint32_t * p = pairs [ t_ ].data ( );
+        for ( std::size_t s = 0; s < n_; ++s ) {
+            const In x  = ( In ) rng ( );
+            const Out h = f_.f ( x );
+            for ( int i = 0; i < in_bits; ++i ) {
+                const Out d = h ^ f_.f ( x ^ ( In { 1 } << i ) );
+                for ( Out r = d; r; r &= r - 1 ) {
+                    std::uint32_t * row = p + ( i * out_bits + iu::tzCount ( r ) ) * out_bits;
+                    for ( int k = 0; k < out_bits; ++k ) {
+                        row [ k ] += ( d >> k ) & 1;
+                    }
+                }
+            }
+        }
+    } );
+    for ( unsigned t = 1; t < threads; ++t ) {
+        for ( std::size_t k = 0; k < pairs [ 0 ].size ( ); ++k ) {
+            pairs [ 0 ] [ k ] += pairs [ t ] [ k ];
+        }
+    }
+    const std::uint32_t * p = pairs [ 0 ].data ( );
+    const double n = ( double ) samples_;
+    double sum = 0.0, worst = 0.0;
+    std::size_t count = 0;
+    for ( int i = 0; i < in_bits; ++i ) {
+        const std::uint32_t * m = p + i * out_bits * out_bits;
+        for ( int j = 0; j < out_bits; ++j ) {
+            for ( int k = j + 1; k < out_bits; ++k ) {
+                const double pj = m [ j * out_bits + j ] / n, pk = m [ k * out_bits + k ] / n, pjk = m [ j * out_bits + k ] / n;
+                const double v = pj * ( 1.0 - pj ) * pk * ( 1.0 - pk );
+                const double r = v > 0.0 ? std::abs ( pjk - pj * pk ) / std::sqrt ( v ) : 1.0;
+                sum += r * r;
+                worst = std::max ( worst, r );
+                ++count;
+            }
+        }
+    }
+    std::printf ( " %10.7f %8.5f", std::sqrt ( sum / count ), worst );
+}
+
+// Collisions of the low and high half of the output, for 2 ^ ( half / 2 + 4 )
+// keys, 128 are expected.
+template<typename In, typename Out>
+void collisions ( const function<In, Out> & f_ ) {
+    constexpr int half = 4 * sizeof ( Out );
+    const std::size_t n = std::size_t { 1 } << ( half / 2 + 4 );
+    std::vector<Out> lo ( n ), hi ( n );
+    auto count = [ ] ( std::vector<Out> & v_ ) {
+        std::sort ( v_.begin ( ), v_.end ( ) );
+        std::size_t c = 0;
+        for ( std::size_t i = 1; i < v_.size ( ); ++i ) {
+            c += v_ [ i ] == v_ [ i - 1 ];
+        }
+        return c;
+    };
+    sax::splitmix64 rng ( 0xD6E8FEB86659FD93 );
+    for ( int keys = 0; keys < 3; ++keys ) {
+        for ( std::size_t i = 0; i < n; ++i ) {
+            const In x  = keys == 0 ? ( In ) i : keys == 1 ? ( In ) ( i << ( 8 * sizeof ( In ) - half / 2 - 4 ) ) : ( In ) rng ( );
+            const Out h = f_.f ( x );
+            lo [ i ]    = h & ( ( Out { 1 } << half ) - 1 );
+            hi [ i ]    = h >> half;
+        }
+        std::printf ( " %6zu %6zu", count ( lo ), count ( hi ) );
+    }
+}
+
+template<typename In, typename Out>
+void report ( const function<In, Out> & f_, const std::size_t samples_ ) {
+    speed ( f_ );
+    avalanche ( f_, samples_ );
+    bit_independence ( f_, samples_ / 64 );
+    collisions ( f_ );
+    std::printf ( "\n" );
+    std::fflush ( stdout );
+}
+
+// Throughput of the 4-lane AVX2 fmix64 ().
+void fmix64_avx2 ( ) {
+    constexpr std::size_t n = std::size_t { 1 } << 22;
+    std::vector<std::uint64_t> keys ( n );
+    sax::splitmix64 rng ( 0xBEAC0467EBA5FACB );
+    for ( auto & k : keys ) {
+        k = rng ( );
+    }
+    double best = 1e300;
+    __m256i h   = _mm256_setzero_si256 ( );
+    for ( int r = 0; r < 3; ++r ) {
+        const auto start = std::chrono::steady_clock::now ( );
+        for ( std::size_t i = 0; i < n; i += 4 ) {
+            h = _mm256_xor_si256 ( h, iu::fmix64 ( _mm256_loadu_si256 ( ( const __m256i * ) ( keys.data ( ) + i ) ) ) );
+        }
+        best = std::min ( best, std::chrono::duration<double> ( std::chrono::steady_clock::now ( ) - start ).count ( ) );
+    }
+    std::printf ( " %-14s %10s %10.2f %10.2f   (%llx)\n", "fmix64 avx2", "", best / n * 1e9, n * 8 / best / 1e9, ( unsigned long long ) _mm256_extract_epi64 ( h, 0 ) );
+}
+
+auto main ( int argc, char ** argv ) -> int {
+
+    const std::size_t samples = argc > 1 ? std::strtoull ( argv [ 1 ], nullptr, 10 ) : std::size_t { 1 } << 18;
+
+    std::printf ( "%zu samples (%zu for BIC), noise floor of the RMS bias %.7f\n\n", samples, samples / 64, 1.0 / std::sqrt ( ( double ) samples ) );
+    std::printf ( " %-14s %10s %10s %10s %10s %8s %10s %8s %13s %13s %13s\n", "function", "lat ns", "thr ns", "GB/s", "aval rms", "worst", "BIC rms", "worst", "seq lo/hi", "stride lo/hi", "random lo/hi" );
+
+    const function32 f32 [ ] = { { "hash 32", hash32 }, { "hash_combine 32", combine32 }, { "fnv1a 32 (hex)", fnv32 } };
+    for ( const auto & f : f32 ) {
+        report ( f, samples );
+    }
+    const function64 f64 [ ] = { { "hash 64", hash64 }, { "fmix64", fmix64 }, { "hash_bytes 64", bytes64 }, { "hash_combine 64", combine64 }, { "fnv1a 64 (hex)", fnv64 } };
+    for ( const auto & f : f64 ) {
+        report ( f, samples );
+    }
+    fmix64_avx2 ( );
+
+    for ( int i = 2; i < argc; ++i ) {
+        candidate_multiplier = std::strtoull ( argv [ i ], nullptr, 16 );
+        std::printf ( " %s\n", argv [ i ] );
+        report ( function64 { "hash candidate", candidate64 }, samples );
+    }
+
+    return EXIT_SUCCESS;
+}
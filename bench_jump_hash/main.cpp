@@ -0,0 +1,149 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../integer_utils.hpp"
+
+// Bucket assignment of 64-bit keys: hash % n vs rendezvous hashing vs
+// iu::jump_hash () vs iu::jump_hash_batch (). Reports the throughput,
+// the fraction of keys that move when a bucket is added, and the load of
+// the fullest bucket relative to the average. First checks that
+// iu::jump_hash_batch () gives the buckets of iu::jump_hash (), exits
+// with a failure if not.
+
+std::uint32_t modulo ( const std::uint64_t key_, const std::uint32_t buckets_ ) noexcept {
+    return ( std::uint32_t ) ( iu::fmix64 ( key_ ) % buckets_ );
+}
+
+// Highest random weight, O ( buckets_ ) per key.
+std::uint32_t rendezvous ( const std::uint64_t key_, const std::uint32_t buckets_ ) noexcept {
+    const std::uint64_t h = iu::fmix64 ( key_ );
+    std::uint64_t best = 0;
+    std::uint32_t r    = 0;
+    for ( std::uint32_t b = 0; b < buckets_; ++b ) {
+        const std::uint64_t w = iu::hash ( h ^ ( b * 0x9E3779B97F4A7C15 ) );
+        if ( w > best ) {
+            best = w;
+            r    = b;
+        }
+    }
+    return r;
+}
+
+template<typename Assign>
+void run ( const char * name_, const std::vector<std::uint64_t> & keys_, const std::uint32_t buckets_, Assign assign_ ) {
+    std::vector<std::uint32_t> a ( keys_.size ( ) ), b ( keys_.size ( ) );
+    const auto start = std::chrono::steady_clock::now ( );
+    assign_ ( keys_, buckets_, a );
+    const double s = std::chrono::duration<double> ( std::chrono::steady_clock::now ( ) - start ).count ( );
+    assign_ ( keys_, buckets_ + 1, b );
+    std::size_t moved = 0;
+    std::vector<std::size_t> load ( buckets_ );
+    for ( std::size_t i = 0; i < keys_.size ( ); ++i ) {
+        moved += a [ i ] != b [ i ];
+        ++load [ a [ i ] ];
+    }
+    std::printf ( " %-18s %8u %12.1f %12.4f %10.4f %10.3f\n", name_, buckets_, keys_.size ( ) / s / 1e6, double ( moved ) / keys_.size ( ), 1.0 / ( buckets_ + 1 ), double ( *std::max_element ( load.begin ( ), load.end ( ) ) ) * buckets_ / keys_.size ( ) );
+}
+
+template<std::uint32_t ( *F ) ( std::uint64_t, std::uint32_t )>
+void scalar ( const std::vector<std::uint64_t> & keys_, const std::uint32_t buckets_, std::vector<std::uint32_t> & out_ ) {
+    for ( std::size_t i = 0; i < keys_.size ( ); ++i ) {
+        out_ [ i ] = F ( keys_ [ i ], buckets_ );
+    }
+}
+
+std::uint32_t jump ( std::uint64_t key_, std::uint32_t buckets_ ) noexcept {
+    return iu::jump_hash ( key_, buckets_ );
+}
+std::uint32_t mod ( std::uint64_t key_, std::uint32_t buckets_ ) noexcept {
+    return modulo ( key_, buckets_ );
+}
+std::uint32_t hrw ( std::uint64_t key_, std::uint32_t buckets_ ) noexcept {
+    return rendezvous ( key_, buckets_ );
+}
+
+// jump_hash_batch () against jump_hash (), they compute in double, a
+// difference in rounding (-ffast-math, FMA contraction) picks another
+// bucket. Returns the number of mismatches.
+std::size_t check_batch ( const std::vector<std::uint64_t> & keys_ ) {
+    std::vector<std::uint32_t> a ( keys_.size ( ) ), b ( keys_.size ( ) );
+    std::size_t mismatches = 0;
+    for ( std::uint32_t buckets : { 1u, 2u, 3u, 10u, 100u, 1'000u, 10'000u, 1'000'000u, 0x7FFF'FFFFu, 0xFFFF'FFFFu } ) {
+        scalar<jump> ( keys_, buckets, a );
+        iu::jump_hash_batch ( keys_.data ( ), keys_.size ( ), buckets, b.data ( ) );
+        for ( std::size_t i = 0; i < keys_.size ( ); ++i ) {
+            if ( a [ i ] != b [ i ] && mismatches++ < 10 ) {
+                std::printf ( "mismatch, key %llu, %u buckets, jump_hash %u, jump_hash_batch %u\n", ( unsigned long long ) keys_ [ i ], buckets, a [ i ], b [ i ] );
+            }
+        }
+    }
+    return mismatches;
+}
+
+auto main ( int argc, char ** argv ) -> int {
+
+    const std::size_t n = argc > 1 ? std::strtoull ( argv [ 1 ], nullptr, 10 ) : std::size_t { 1 } << 22;
+
+    std::vector<std::uint64_t> keys ( n );
+    std::uint64_t k = 0;
+    for ( auto & key : keys ) {
+        key = k++; // Sequential ids.
+    }
+
+    {
+        // Sequential and random keys, the length not a multiple of 8.
+        std::vector<std::uint64_t> check ( keys.begin ( ), keys.begin ( ) + std::min<std::size_t> ( n, 1 << 16 ) );
+        std::uint64_t x = 0x9E37'79B9'7F4A'7C15;
+        for ( std::size_t i = 0; i < ( 1 << 16 ) + 5; ++i ) {
+            check.push_back ( x = iu::fmix64 ( x + i ) );
+        }
+        if ( const std::size_t m = check_batch ( check ) ) {
+            std::printf ( "jump_hash_batch disagrees with jump_hash on %zu keys\n", m );
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::printf ( "%zu keys\n method              buckets   Mkeys/s        moved   ideal     max/avg\n", n );
+
+    for ( std::uint32_t buckets : { 10u, 100u, 1'000u, 10'000u, 1'000'000u } ) {
+        run ( "hash % n", keys, buckets, scalar<mod> );
+        if ( buckets <= 1'000u ) {
+            run ( "rendezvous", keys, buckets, scalar<hrw> );
+        }
+        run ( "jump_hash", keys, buckets, scalar<jump> );
+        run ( "jump_hash_batch", keys, buckets, [ ] ( const std::vector<std::uint64_t> & keys_, const std::uint32_t buckets_, std::vector<std::uint32_t> & out_ ) {
+            iu::jump_hash_batch ( keys_.data ( ), keys_.size ( ), buckets_, out_.data ( ) );
+        } );
+    }
+
+    return EXIT_SUCCESS;
+}
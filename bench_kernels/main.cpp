@@ -0,0 +1,389 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <intrin.h>
+#else
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // sched_setaffinity
+#endif
+#include <sched.h>
+#include <time.h>
+#include <x86intrin.h>
+#endif
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../integer_utils.hpp"
+#include "../philox.hpp"
+#include "../shift_rotate_avx2.hpp"
+#include "../simd_xoroshiro.hpp"
+#include "../stream_pool.hpp"
+#include "../xoroshiro_meo.hpp"
+
+// Cycles per operation of the kernels of the library.
+//
+// bench_kernels [ -c cpu ] [ -s samples ] [ -f filter ] [ -l label ] [ -j ]
+//
+//   -c cpu      pin to that cpu, -1 to not pin, the default is 0.
+//   -s samples  samples per kernel and mode, the default is 201.
+//   -f filter   only the kernels with filter in their name.
+//   -l label    a label for the run (the commit, say) in the JSON.
+//   -j          JSON to stdout, instead of a table.
+//
+// Every kernel is timed in two modes. Throughput: the calls are
+// independent, on an array of inputs. Latency: the input of a call
+// depends on the result of the previous call (x + ( r & zero ), zero is
+// 0 but the compiler can't know), the baseline kernel is the cost of
+// that dependency, subtract it. A sample is the rdtsc ( ) ... rdtscp ( )
+// ticks of a batch of calls (at least 20'000 ticks) divided by the
+// calls, after a warmup of 10% of the samples, the min, percentiles and
+// median of the samples are reported. The ticks are those of the time
+// stamp counter, the reference (not the actual, turbo) clock of the cpu,
+// calibrated against clock_gettime ( ), the ns are ticks / GHz. The
+// generators are only timed for throughput.
+
+namespace {
+
+constexpr std::size_t inputs = 1024; // Cycled through, in L1.
+
+struct options {
+    int cpu          = 0;
+    unsigned samples = 201;
+    std::string filter, label;
+    bool json = false;
+};
+
+struct result {
+    std::string name;
+    const char * mode;
+    std::size_t batch;
+    double min, p10, median, p90, p99;
+};
+
+std::vector<result> results;
+double tsc_ghz = 0.0;
+
+inline std::uint64_t tsc_start ( ) noexcept {
+    _mm_lfence ( );
+    const std::uint64_t t = __rdtsc ( );
+    _mm_lfence ( );
+    return t;
+}
+
+inline std::uint64_t tsc_stop ( ) noexcept {
+    unsigned aux;
+    const std::uint64_t t = __rdtscp ( &aux );
+    _mm_lfence ( );
+    return t;
+}
+
+std::uint64_t now_ns ( ) noexcept {
+#ifdef _WIN32
+    return ( std::uint64_t ) std::chrono::duration_cast<std::chrono::nanoseconds> ( std::chrono::steady_clock::now ( ).time_since_epoch ( ) ).count ( );
+#else
+    timespec ts;
+    clock_gettime ( CLOCK_MONOTONIC_RAW, &ts );
+    return ( std::uint64_t ) ts.tv_sec * 1'000'000'000 + ( std::uint64_t ) ts.tv_nsec;
+#endif
+}
+
+bool pin ( const int cpu_ ) noexcept {
+#ifdef _WIN32
+    return SetThreadAffinityMask ( GetCurrentThread ( ), DWORD_PTR { 1 } << cpu_ ) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO ( &set );
+    CPU_SET ( cpu_, &set );
+    return sched_setaffinity ( 0, sizeof ( set ), &set ) == 0;
+#endif
+}
+
+// Spins for 200 ms (the clock ramps up), the tsc ticks per ns over that time.
+double calibrate ( ) noexcept {
+    const std::uint64_t n0 = now_ns ( ), t0 = tsc_start ( );
+    std::uint64_t n1;
+    while ( ( n1 = now_ns ( ) ) - n0 < 200'000'000 ) {
+    }
+    return double ( tsc_stop ( ) - t0 ) / double ( n1 - n0 );
+}
+
+// Zero, opaque to the optimizer.
+volatile std::uint64_t volatile_zero = 0;
+// Results are written here, so they can't be optimized away.
+volatile std::uint8_t volatile_sink = 0;
+
+// The dependency of the latency mode.
+template<typename T, typename R>
+inline T depend ( const T x_, const R r_, const std::uint64_t zero_ ) noexcept {
+    if constexpr ( std::is_same<T, __m256i>::value ) {
+        return _mm256_xor_si256 ( x_, _mm256_and_si256 ( r_, _mm256_set1_epi64x ( ( long long ) zero_ ) ) );
+    }
+    else {
+        return x_ + ( T ) ( ( std::uint64_t ) r_ & zero_ );
+    }
+}
+
+template<typename R>
+inline void sink ( R & s_, const R r_ ) noexcept {
+    if constexpr ( std::is_same<R, __m256i>::value ) {
+        s_ = _mm256_xor_si256 ( s_, r_ );
+    }
+    else {
+        s_ ^= r_;
+    }
+}
+
+template<typename R>
+inline void keep ( const R & r_ ) noexcept {
+    std::uint8_t b [ sizeof ( R ) ];
+    std::memcpy ( b, &r_, sizeof ( R ) );
+    std::uint8_t x = 0;
+    for ( std::uint8_t c : b ) {
+        x ^= c;
+    }
+    volatile_sink = x;
+}
+
+// Ticks per call of n_ calls of f_.
+template<bool Latency, typename T, typename F>
+double sample ( const T * x_, const T * y_, const std::size_t n_, F & f_ ) noexcept {
+    using R                  = decltype ( f_ ( x_ [ 0 ], y_ [ 0 ] ) );
+    const std::uint64_t zero = volatile_zero;
+    R s;
+    std::memset ( &s, 0, sizeof ( R ) );
+    const std::uint64_t t0 = tsc_start ( );
+    if constexpr ( Latency ) {
+        T x = x_ [ 0 ];
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            s = f_ ( x, y_ [ i % inputs ] );
+            x = depend ( x_ [ ( i + 1 ) % inputs ], s, zero );
+        }
+    }
+    else {
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            sink ( s, f_ ( x_ [ i % inputs ], y_ [ i % inputs ] ) );
+        }
+    }
+    const std::uint64_t t1 = tsc_stop ( );
+    keep ( s );
+    return double ( t1 - t0 ) / double ( n_ );
+}
+
+template<bool Latency, typename T, typename F>
+void measure ( const char * name_, const char * mode_, const options & o_, const T * x_, const T * y_, F & f_ ) {
+    // The batch, long enough for the overhead of the timing to vanish.
+    std::size_t n = 64;
+    while ( n < ( std::size_t { 1 } << 24 ) && sample<Latency> ( x_, y_, n, f_ ) * n < 20'000.0 ) {
+        n *= 2;
+    }
+    for ( unsigned i = 0; i < o_.samples / 10 + 1; ++i ) {
+        sample<Latency> ( x_, y_, n, f_ );
+    }
+    std::vector<double> s ( o_.samples );
+    for ( double & t : s ) {
+        t = sample<Latency> ( x_, y_, n, f_ );
+    }
+    std::sort ( s.begin ( ), s.end ( ) );
+    const auto at = [ & ] ( const double q_ ) { return s [ ( std::size_t ) ( q_ * ( s.size ( ) - 1 ) + 0.5 ) ]; };
+    results.push_back ( { name_, mode_, n, s.front ( ), at ( 0.1 ), at ( 0.5 ), at ( 0.9 ), at ( 0.99 ) } );
+    const result & r = results.back ( );
+    if ( !o_.json ) {
+        std::printf ( " %-44s %-10s %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", name_, mode_, r.min, r.p10, r.median, r.p90, r.p99, r.median / tsc_ghz );
+        std::fflush ( stdout );
+    }
+}
+
+// Binary kernels f_ ( x, y ), x and y drawn from make_ ( rng ).
+template<typename T, typename F, typename Make>
+void bench ( const char * name_, const options & o_, F f_, Make make_, const bool latency_ = true ) {
+    if ( o_.filter.size ( ) && !std::strstr ( name_, o_.filter.c_str ( ) ) ) {
+        return;
+    }
+    sax::splitmix64 rng ( 0x5851F42D4C957F2D );
+    std::vector<T> x ( inputs ), y ( inputs );
+    for ( std::size_t i = 0; i < inputs; ++i ) {
+        x [ i ] = make_ ( rng );
+        y [ i ] = make_ ( rng );
+    }
+    measure<false> ( name_, "throughput", o_, x.data ( ), y.data ( ), f_ );
+    if ( latency_ ) {
+        measure<true> ( name_, "latency", o_, x.data ( ), y.data ( ), f_ );
+    }
+}
+
+template<typename T, typename F>
+void bench ( const char * name_, const options & o_, F f_ ) {
+    bench<T> ( name_, o_, f_, [ ] ( sax::splitmix64 & rng_ ) { return ( T ) rng_ ( ); } );
+}
+
+// gen ( ), throughput only, the input of a call can't depend on the
+// previous value, the calls depend on each other through the state.
+template<typename Gen>
+void bench_generator ( const char * name_, const options & o_ ) {
+    Gen gen = iu::detail::make_generator<Gen> ( 0xBEAC0467EBA5FACB );
+    bench<std::uint64_t> (
+        name_, o_, [ & ] ( std::uint64_t, std::uint64_t ) { return ( std::uint64_t ) gen ( ); }, [ ] ( sax::splitmix64 & rng_ ) { return rng_ ( ); }, false );
+}
+
+__m256i make_m256i ( sax::splitmix64 & rng_ ) noexcept {
+    return _mm256_set_epi64x ( ( long long ) rng_ ( ), ( long long ) rng_ ( ), ( long long ) rng_ ( ), ( long long ) rng_ ( ) );
+}
+
+// s_ as the contents of a JSON string.
+std::string json_escape ( const std::string & s_ ) {
+    std::string e;
+    for ( const char c : s_ ) {
+        if ( c == '"' || c == '\\' ) {
+            e += '\\';
+            e += c;
+        }
+        else if ( ( unsigned char ) c < 0x20 ) {
+            char u [ 8 ];
+            std::snprintf ( u, sizeof ( u ), "\\u%04x", ( unsigned ) c );
+            e += u;
+        }
+        else {
+            e += c;
+        }
+    }
+    return e;
+}
+
+void json ( const options & o_, const int pinned_ ) {
+    std::printf ( "{\n  \"label\": \"%s\",\n  \"tsc_ghz\": %.4f,\n  \"cpu\": %d,\n  \"samples\": %u,\n  \"unit\": \"tsc ticks per call\",\n  \"results\": [\n", json_escape ( o_.label ).c_str ( ), tsc_ghz, pinned_, o_.samples );
+    for ( std::size_t i = 0; i < results.size ( ); ++i ) {
+        const result & r = results [ i ];
+        std::printf ( "    { \"name\": \"%s\", \"mode\": \"%s\", \"batch\": %zu, \"min\": %.3f, \"p10\": %.3f, \"median\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"median_ns\": %.3f }%s\n", json_escape ( r.name ).c_str ( ), r.mode, r.batch, r.min, r.p10, r.median, r.p90, r.p99, r.median / tsc_ghz, i + 1 < results.size ( ) ? "," : "" );
+    }
+    std::printf ( "  ]\n}\n" );
+}
+} // namespace
+
+auto main ( int argc, char ** argv ) -> int {
+
+    options o;
+
+    for ( int i = 1; i < argc; ++i ) {
+        const std::string a  = argv [ i ];
+        const bool has_value = i + 1 < argc;
+        if ( a == "-c" && has_value ) {
+            o.cpu = std::atoi ( argv [ ++i ] );
+        }
+        else if ( a == "-s" && has_value ) {
+            o.samples = std::max ( ( unsigned ) std::strtoul ( argv [ ++i ], nullptr, 10 ), 1u );
+        }
+        else if ( a == "-f" && has_value ) {
+            o.filter = argv [ ++i ];
+        }
+        else if ( a == "-l" && has_value ) {
+            o.label = argv [ ++i ];
+        }
+        else if ( a == "-j" ) {
+            o.json = true;
+        }
+        else {
+            std::fprintf ( stderr, "bench_kernels [ -c cpu ] [ -s samples ] [ -f filter ] [ -l label ] [ -j ]\n" );
+            return a == "-h" || a == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    const int pinned = o.cpu >= 0 && pin ( o.cpu ) ? o.cpu : -1;
+    if ( o.cpu >= 0 && pinned < 0 ) {
+        std::fprintf ( stderr, "could not pin to cpu %d\n", o.cpu );
+    }
+    tsc_ghz = calibrate ( );
+
+    if ( !o.json ) {
+        std::printf ( "tsc %.3f GHz, cpu %d, %u samples, ticks per call\n kernel                                       mode             min       p10    median       p90       p99 median ns\n", tsc_ghz, pinned, o.samples );
+    }
+
+    using u8  = std::uint8_t;
+    using u16 = std::uint16_t;
+    using u32 = std::uint32_t;
+    using u64 = std::uint64_t;
+
+    bench<u64> ( "baseline", o, [ ] ( u64 x_, u64 ) { return x_; } );
+
+    bench<u32> ( "gcd<u32>", o, [ ] ( u32 x_, u32 y_ ) { return iu::gcd ( x_, y_ ); } );
+    bench<u64> ( "gcd<u64>", o, [ ] ( u64 x_, u64 y_ ) { return iu::gcd ( x_, y_ ); } );
+    bench<u32> ( "ilog2<u32>", o, [ ] ( u32 x_, u32 ) { return iu::ilog2 ( x_ | 1 ); } );
+    bench<u64> ( "ilog2<u64>", o, [ ] ( u64 x_, u64 ) { return iu::ilog2 ( x_ | 1 ); } );
+    // Odd (is_prime ( ) asserts that), random values.
+    bench<u32> ( "is_prime<u32>", o, [ ] ( u32 x_, u32 ) { return iu::is_prime ( x_ | 1 ); } );
+    bench<u64> ( "is_prime<u64>", o, [ ] ( u64 x_, u64 ) { return iu::is_prime ( x_ | 1 ); } );
+    bench<u16> ( "mod_mul_inv<u16>", o, [ ] ( u16 x_, u16 ) { return iu::mod_mul_inv ( ( u16 ) ( x_ | 1 ) ); } );
+    bench<u32> ( "mod_mul_inv<u32>", o, [ ] ( u32 x_, u32 ) { return iu::mod_mul_inv ( x_ | 1 ); } );
+    bench<u64> ( "mod_mul_inv<u64>", o, [ ] ( u64 x_, u64 ) { return iu::mod_mul_inv ( x_ | 1 ); } );
+    bench<u32> ( "hash<u32>", o, [ ] ( u32 x_, u32 ) { return iu::hash ( x_ ); } );
+    bench<u64> ( "hash<u64>", o, [ ] ( u64 x_, u64 ) { return iu::hash ( x_ ); } );
+    bench<u32> ( "unhash<u32>", o, [ ] ( u32 x_, u32 ) { return iu::unhash ( x_ ); } );
+    bench<u64> ( "unhash<u64>", o, [ ] ( u64 x_, u64 ) { return iu::unhash ( x_ ); } );
+    bench<u64> ( "fmix64", o, [ ] ( u64 x_, u64 ) { return iu::fmix64 ( x_ ); } );
+    bench<__m256i> ( "fmix64<__m256i>", o, [ ] ( __m256i x_, __m256i ) { return iu::fmix64 ( x_ ); }, make_m256i );
+    bench<u8> ( "gray2dec<u8>", o, [ ] ( u8 x_, u8 ) { return iu::gray2dec ( x_ ); } );
+    bench<u16> ( "gray2dec<u16>", o, [ ] ( u16 x_, u16 ) { return iu::gray2dec ( x_ ); } );
+    bench<u32> ( "gray2dec<u32>", o, [ ] ( u32 x_, u32 ) { return iu::gray2dec ( x_ ); } );
+    bench<u64> ( "gray2dec<u64>", o, [ ] ( u64 x_, u64 ) { return iu::gray2dec ( x_ ); } );
+    bench<u32> ( "popCount<u32>", o, [ ] ( u32 x_, u32 ) { return iu::popCount ( x_ ); } );
+    bench<u64> ( "popCount<u64>", o, [ ] ( u64 x_, u64 ) { return iu::popCount ( x_ ); } );
+    bench<__m256i> ( "_mm256_sli_si256", o, [ ] ( __m256i x_, __m256i y_ ) { return _mm256_sli_si256 ( x_, _mm256_extract_epi32 ( y_, 0 ) & 255 ); }, make_m256i );
+    bench<__m256i> ( "_mm256_sri_si256", o, [ ] ( __m256i x_, __m256i y_ ) { return _mm256_sri_si256 ( x_, _mm256_extract_epi32 ( y_, 0 ) & 255 ); }, make_m256i );
+    bench<__m256i> ( "_mm256_rli_si256", o, [ ] ( __m256i x_, __m256i y_ ) { return _mm256_rli_si256 ( x_, _mm256_extract_epi32 ( y_, 0 ) & 255 ); }, make_m256i );
+    bench<__m256i> ( "_mm256_rri_si256", o, [ ] ( __m256i x_, __m256i y_ ) { return _mm256_rri_si256 ( x_, _mm256_extract_epi32 ( y_, 0 ) & 255 ); }, make_m256i );
+
+    bench_generator<sax::splitmix64> ( "sax::splitmix64", o );
+    bench_generator<iu::xoroshiro128plus64> ( "iu::xoroshiro128plus64", o );
+    bench_generator<iu::xoroshiro4x128plusavx> ( "iu::xoroshiro4x128plusavx", o );
+    if ( iu::xoroshiro8x128plusavx512::is_supported ( ) ) {
+        bench_generator<iu::xoroshiro8x128plusavx512> ( "iu::xoroshiro8x128plusavx512", o );
+    }
+    bench_generator<iu::philox4x64> ( "iu::philox4x64", o );
+    bench_generator<iu::simd_xoroshiro<meo::xoroshiro128plus64>> ( "iu::simd_xoroshiro<xoroshiro128plus64>", o );
+    bench_generator<iu::simd_xoroshiro<meo::xoroshiro128starstar64>> ( "iu::simd_xoroshiro<xoroshiro128starstar64>", o );
+    bench_generator<meo::xoroshiro128plus64> ( "meo::xoroshiro128plus64", o );
+    bench_generator<meo::xoroshiro128starstar64> ( "meo::xoroshiro128starstar64", o );
+    bench_generator<meo::xoroshiro128plus32> ( "meo::xoroshiro128plus32", o );
+    bench_generator<meo::xoroshiro64starstar32> ( "meo::xoroshiro64starstar32", o );
+    bench_generator<meo::xoroshiro32plus16> ( "meo::xoroshiro32plus16", o );
+
+    if ( o.json ) {
+        json ( o, pinned );
+    }
+
+    return EXIT_SUCCESS;
+}
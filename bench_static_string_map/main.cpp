@@ -0,0 +1,102 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../integer_utils.hpp"
+#include "../static_string_map.hpp"
+
+// Protocol keyword dispatch: iu::static_string_map vs std::unordered_map
+// vs binary search in a sorted std::array, 1 in 8 lookups misses.
+
+constexpr std::pair<std::string_view, int> keyword_list [ ] = {
+    { "GET", 1 },         { "PUT", 2 },            { "POST", 3 },         { "DELETE", 4 },    { "HEAD", 5 },
+    { "OPTIONS", 6 },     { "PATCH", 7 },          { "CONNECT", 8 },      { "TRACE", 9 },     { "SUBSCRIBE", 10 },
+    { "UNSUBSCRIBE", 11 },{ "PUBLISH", 12 },       { "PING", 13 },        { "PONG", 14 },     { "AUTH", 15 },
+    { "LOGIN", 16 },      { "LOGOUT", 17 },        { "HEARTBEAT", 18 },   { "ACK", 19 },      { "NACK", 20 },
+    { "BEGIN", 21 },      { "COMMIT", 22 },        { "ABORT", 23 },       { "SEND", 24 },     { "RECEIPT", 25 },
+    { "ERROR", 26 },      { "MESSAGE", 27 },       { "DISCONNECT", 28 },  { "STATUS", 29 },   { "CONTENT-LENGTH", 30 },
+    { "CONTENT-TYPE", 31 },{ "TRANSFER-ENCODING", 32 }
+};
+
+constexpr std::size_t keyword_count = sizeof ( keyword_list ) / sizeof ( keyword_list [ 0 ] );
+
+constexpr auto keywords = iu::make_static_string_map<int> ( keyword_list );
+
+static_assert ( *keywords.find ( "HEARTBEAT" ) == 18, "" );
+static_assert ( !keywords.contains ( "HEARTBEET" ), "" );
+
+template<typename Lookup>
+void run ( const char * name_, const std::vector<std::string> & messages_, Lookup lookup_ ) {
+    std::int64_t sum = 0;
+    const auto start = std::chrono::steady_clock::now ( );
+    for ( int r = 0; r < 4096; ++r ) {
+        for ( const auto & m : messages_ ) {
+            sum += lookup_ ( std::string_view { m } );
+        }
+    }
+    const double s = std::chrono::duration<double> ( std::chrono::steady_clock::now ( ) - start ).count ( );
+    std::printf ( "%-20s %6.2f ns/lookup (%lld)\n", name_, s * 1e9 / ( 4096.0 * messages_.size ( ) ), ( long long ) sum );
+}
+
+auto main ( ) -> int {
+
+    std::vector<std::string> messages ( 1 << 12 );
+    sax::splitmix64 rng ( 0xBEAC0467EBA5FACB );
+    for ( auto & m : messages ) {
+        const std::uint64_t r = rng ( );
+        m = std::string { keyword_list [ r % keyword_count ].first };
+        if ( !( ( r >> 32 ) & 7 ) ) {
+            m.back ( ) = '_';
+        }
+    }
+
+    const std::unordered_map<std::string_view, int> map ( std::begin ( keyword_list ), std::end ( keyword_list ) );
+
+    std::array<std::pair<std::string_view, int>, keyword_count> sorted;
+    std::copy ( std::begin ( keyword_list ), std::end ( keyword_list ), sorted.begin ( ) );
+    std::sort ( sorted.begin ( ), sorted.end ( ) );
+
+    run ( "static_string_map", messages, [ ] ( const std::string_view k_ ) { return keywords.value_or ( k_, 0 ); } );
+    run ( "unordered_map", messages, [ &map ] ( const std::string_view k_ ) {
+        const auto it = map.find ( k_ );
+        return it == map.end ( ) ? 0 : it->second;
+    } );
+    run ( "sorted array", messages, [ &sorted ] ( const std::string_view k_ ) {
+        const auto it = std::lower_bound ( sorted.begin ( ), sorted.end ( ), k_, [ ] ( const auto & a_, const std::string_view b_ ) { return a_.first < b_; } );
+        return it != sorted.end ( ) && it->first == k_ ? it->second : 0;
+    } );
+
+    return EXIT_SUCCESS;
+}
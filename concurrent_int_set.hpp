@@ -0,0 +1,150 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+// Fixed capacity, lock-free set of 32- or 64-bit unsigned integers.
+//
+// Linear probing over an array of atomic words, a word is claimed with a
+// single CAS. As iu::hash () is a bijection, the stored word hash ( key )
+// is the key, there is no separate key array and nothing is published
+// along with the word, so relaxed ordering suffices. contains () is
+// wait-free, insert () is lock-free. The one key that hashes to 0 (the
+// empty marker) is kept in a separate flag. Elements can't be erased
+// concurrently.
+template<typename K>
+class concurrent_int_set {
+
+    static_assert ( std::is_same<K, std::uint32_t>::value || std::is_same<K, std::uint64_t>::value, "K should be std::uint32_t or std::uint64_t" );
+
+    public:
+
+    using key_type  = K;
+    using size_type = std::size_t;
+
+    enum class insert_result { inserted, present, full };
+
+    // The table holds max_size_ elements at a load factor of at most 1/2.
+    explicit concurrent_int_set ( const size_type max_size_ ) :
+        m_mask { next_power_2<std::size_t> ( max_size_ < 8 ? 16 : 2 * max_size_ ) - 1 },
+        m_table { new std::atomic<K> [ m_mask + 1 ] } {
+        clear ( );
+    }
+
+    concurrent_int_set ( const concurrent_int_set & ) = delete;
+    concurrent_int_set & operator = ( const concurrent_int_set & ) = delete;
+
+    // Returns inserted, present (it was there already) or full (no free
+    // slot, key_ is not in the set).
+    insert_result insert ( const K key_ ) noexcept {
+        const K h = iu::hash ( key_ );
+        if ( !h ) {
+            return m_zero.exchange ( true, std::memory_order_relaxed ) ? insert_result::present : insert_result::inserted;
+        }
+        std::size_t i = ( std::size_t ) h & m_mask;
+        for ( std::size_t n = 0; n <= m_mask; ++n, i = ( i + 1 ) & m_mask ) {
+            K w = m_table [ i ].load ( std::memory_order_relaxed );
+            if ( !w ) {
+                if ( m_table [ i ].compare_exchange_strong ( w, h, std::memory_order_relaxed ) ) {
+                    return insert_result::inserted;
+                }
+                // Lost the race, w now holds the winner.
+            }
+            if ( w == h ) {
+                return insert_result::present;
+            }
+        }
+        return insert_result::full;
+    }
+
+    bool contains ( const K key_ ) const noexcept {
+        const K h = iu::hash ( key_ );
+        if ( !h ) {
+            return m_zero.load ( std::memory_order_relaxed );
+        }
+        std::size_t i = ( std::size_t ) h & m_mask;
+        for ( std::size_t n = 0; n <= m_mask; ++n, i = ( i + 1 ) & m_mask ) {
+            const K w = m_table [ i ].load ( std::memory_order_relaxed );
+            if ( w == h ) {
+                return true;
+            }
+            if ( !w ) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // The following are not safe to call concurrently with insert ().
+
+    // Counts the elements, O ( capacity ).
+    size_type size ( ) const noexcept {
+        size_type s = m_zero.load ( std::memory_order_relaxed );
+        for ( std::size_t i = 0; i <= m_mask; ++i ) {
+            s += m_table [ i ].load ( std::memory_order_relaxed ) != 0;
+        }
+        return s;
+    }
+
+    size_type capacity ( ) const noexcept {
+        return m_mask + 1;
+    }
+
+    void clear ( ) noexcept {
+        for ( std::size_t i = 0; i <= m_mask; ++i ) {
+            m_table [ i ].store ( 0, std::memory_order_relaxed );
+        }
+        m_zero.store ( false, std::memory_order_relaxed );
+    }
+
+    // Calls f_ ( key ) for every element, keys are recovered with iu::unhash ().
+    template<typename F>
+    void for_each ( F && f_ ) const {
+        if ( m_zero.load ( std::memory_order_relaxed ) ) {
+            f_ ( iu::unhash ( K { 0 } ) );
+        }
+        for ( std::size_t i = 0; i <= m_mask; ++i ) {
+            const K w = m_table [ i ].load ( std::memory_order_relaxed );
+            if ( w ) {
+                f_ ( iu::unhash ( w ) );
+            }
+        }
+    }
+
+    private:
+
+    const std::size_t m_mask;
+    std::unique_ptr<std::atomic<K> [ ]> m_table;
+    std::atomic<bool> m_zero;
+};
+} // namespace iu
@@ -0,0 +1,278 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+namespace {
+
+inline std::uint64_t load64 ( const std::uint8_t * p_ ) noexcept {
+    std::uint64_t v;
+    std::memcpy ( &v, p_, sizeof ( v ) );
+    return v;
+}
+
+// Reflected CRC's, bit 0 of the state is the coefficient of x ^ ( w - 1 ).
+
+constexpr std::uint32_t crc32c_poly = 0x82F63B78;         // 0x1EDC6F41 reflected.
+constexpr std::uint64_t crc64_poly  = 0xC96C5795D7870F42; // 0x42F0E1EBA9EA3693 reflected.
+
+template<typename T, T Poly>
+constexpr std::array<T, 256> make_crc_table ( ) noexcept {
+    std::array<T, 256> t { };
+    for ( std::size_t i = 0; i < 256; ++i ) {
+        T c = ( T ) i;
+        for ( int k = 0; k < 8; ++k ) {
+            c = c & 1 ? ( c >> 1 ) ^ Poly : c >> 1;
+        }
+        t [ i ] = c;
+    }
+    return t;
+}
+
+constexpr std::array<std::uint64_t, 256> crc64_table = make_crc_table<std::uint64_t, crc64_poly> ( );
+
+inline std::uint64_t crc64_bytes ( std::uint64_t s_, const std::uint8_t * p_, std::size_t n_ ) noexcept {
+    for ( ; n_; --n_ ) {
+        s_ = crc64_table [ ( s_ ^ *p_++ ) & 0xFF ] ^ ( s_ >> 8 );
+    }
+    return s_;
+}
+
+// The fold constants, for a distance of D bits: ( x ^ ( D + 63 ) mod P,
+// x ^ ( D - 1 ) mod P ), bit-reflected (in 64 bits). A 128-bit chunk A
+// is moved D bits forward as A.lo * k [ 0 ] + A.hi * k [ 1 ].
+struct fold_constants {
+    std::uint64_t d128 [ 2 ], d256 [ 2 ], d384 [ 2 ], d512 [ 2 ], d2048 [ 2 ];
+};
+
+constexpr fold_constants crc32c_fold = {
+    { 0x3743F7BD00000000, 0x3171D43000000000 }, { 0x33CCBBBC00000000, 0xA2158B3400000000 }, { 0xA46EF4AA00000000, 0x6051243F00000000 },
+    { 0x1C19243B00000000, 0x75BBA45B00000000 }, { 0xE9A5D8BE00000000, 0x1426A81500000000 }
+};
+constexpr fold_constants crc64_fold = {
+    { 0xE05DD497CA393AE4, 0xDABE95AFC7875F40 }, { 0x60095B008A9EFA44, 0x3BE653A30FE1AF51 }, { 0xB5EA1AF9C013ACA4, 0x69A35D91C3730254 },
+    { 0x6AE3EFBB9DD441F3, 0x081F6054A7842DF4 }, { 0x8260ADF2381AD81C, 0xF31FD9271E228B79 }
+};
+
+inline __m128i constants ( const std::uint64_t ( &k_ ) [ 2 ] ) noexcept {
+    return _mm_set_epi64x ( ( long long ) k_ [ 1 ], ( long long ) k_ [ 0 ] );
+}
+
+inline __m128i fold ( const __m128i x_, const __m128i k_ ) noexcept {
+    return _mm_xor_si128 ( _mm_clmulepi64_si128 ( x_, k_, 0x00 ), _mm_clmulepi64_si128 ( x_, k_, 0x11 ) );
+}
+
+inline __m128i load ( const std::uint8_t * p_ ) noexcept {
+    return _mm_loadu_si128 ( ( const __m128i * ) p_ );
+}
+
+#if defined ( __VPCLMULQDQ__ ) && defined ( __AVX512F__ )
+inline __m512i fold ( const __m512i x_, const __m512i k_ ) noexcept {
+    return _mm512_xor_si512 ( _mm512_clmulepi64_epi128 ( x_, k_, 0x00 ), _mm512_clmulepi64_epi128 ( x_, k_, 0x11 ) );
+}
+#endif
+
+// Folds the data (n_ >= 64) down to 128 bits that are congruent to it (mod P),
+// init_ (the CRC state) is added to the first bytes. Returns the number of
+// bytes left over (less than 16).
+inline std::size_t fold_to_128 ( const std::uint8_t *& p_, std::size_t n_, const __m128i init_, const fold_constants & k_, __m128i & r_ ) noexcept {
+    __m128i x0, x1, x2, x3;
+#if defined ( __VPCLMULQDQ__ ) && defined ( __AVX512F__ )
+    if ( n_ >= 256 ) {
+        // 4 x 4 lanes of 128 bits.
+        const __m512i k2048 = _mm512_broadcast_i32x4 ( constants ( k_.d2048 ) ), k512 = _mm512_broadcast_i32x4 ( constants ( k_.d512 ) );
+        __m512i z0 = _mm512_xor_si512 ( _mm512_loadu_si512 ( p_ ), _mm512_zextsi128_si512 ( init_ ) ), z1 = _mm512_loadu_si512 ( p_ + 64 ),
+                z2 = _mm512_loadu_si512 ( p_ + 128 ), z3 = _mm512_loadu_si512 ( p_ + 192 );
+        for ( p_ += 256, n_ -= 256; n_ >= 256; p_ += 256, n_ -= 256 ) {
+            z0 = _mm512_xor_si512 ( fold ( z0, k2048 ), _mm512_loadu_si512 ( p_ ) );
+            z1 = _mm512_xor_si512 ( fold ( z1, k2048 ), _mm512_loadu_si512 ( p_ + 64 ) );
+            z2 = _mm512_xor_si512 ( fold ( z2, k2048 ), _mm512_loadu_si512 ( p_ + 128 ) );
+            z3 = _mm512_xor_si512 ( fold ( z3, k2048 ), _mm512_loadu_si512 ( p_ + 192 ) );
+        }
+        z1 = _mm512_xor_si512 ( fold ( z0, k512 ), z1 );
+        z2 = _mm512_xor_si512 ( fold ( z1, k512 ), z2 );
+        z3 = _mm512_xor_si512 ( fold ( z2, k512 ), z3 );
+        for ( ; n_ >= 64; p_ += 64, n_ -= 64 ) {
+            z3 = _mm512_xor_si512 ( fold ( z3, k512 ), _mm512_loadu_si512 ( p_ ) );
+        }
+        x0 = _mm512_extracti32x4_epi32 ( z3, 0 );
+        x1 = _mm512_extracti32x4_epi32 ( z3, 1 );
+        x2 = _mm512_extracti32x4_epi32 ( z3, 2 );
+        x3 = _mm512_extracti32x4_epi32 ( z3, 3 );
+    }
+    else
+#endif
+    {
+        // 4 lanes of 128 bits.
+        const __m128i k512 = constants ( k_.d512 );
+        x0 = _mm_xor_si128 ( load ( p_ ), init_ );
+        x1 = load ( p_ + 16 );
+        x2 = load ( p_ + 32 );
+        x3 = load ( p_ + 48 );
+        for ( p_ += 64, n_ -= 64; n_ >= 64; p_ += 64, n_ -= 64 ) {
+            x0 = _mm_xor_si128 ( fold ( x0, k512 ), load ( p_ ) );
+            x1 = _mm_xor_si128 ( fold ( x1, k512 ), load ( p_ + 16 ) );
+            x2 = _mm_xor_si128 ( fold ( x2, k512 ), load ( p_ + 32 ) );
+            x3 = _mm_xor_si128 ( fold ( x3, k512 ), load ( p_ + 48 ) );
+        }
+    }
+    const __m128i k128 = constants ( k_.d128 );
+    x3 = _mm_xor_si128 ( _mm_xor_si128 ( fold ( x0, constants ( k_.d384 ) ), fold ( x1, constants ( k_.d256 ) ) ), _mm_xor_si128 ( fold ( x2, k128 ), x3 ) );
+    for ( ; n_ >= 16; p_ += 16, n_ -= 16 ) {
+        x3 = _mm_xor_si128 ( fold ( x3, k128 ), load ( p_ ) );
+    }
+    r_ = x3;
+    return n_;
+}
+
+// a_ * b_ mod P, reflected (zlib's multmodp ()).
+template<typename T, T Poly>
+constexpr T mul_mod_p ( const T a_, T b_ ) noexcept {
+    T m = T { 1 } << ( 8 * sizeof ( T ) - 1 ), p = 0;
+    for ( ; m; m >>= 1 ) {
+        if ( a_ & m ) {
+            p ^= b_;
+        }
+        b_ = b_ & 1 ? ( b_ >> 1 ) ^ Poly : b_ >> 1;
+    }
+    return p;
+}
+
+// x ^ ( 2 ^ k ) mod P, for k in [ 0, 64 ).
+template<typename T, T Poly>
+constexpr std::array<T, 64> make_x2n_table ( ) noexcept {
+    std::array<T, 64> t { };
+    T p = T { 1 } << ( 8 * sizeof ( T ) - 2 ); // x ^ 1
+    for ( std::size_t k = 0; k < 64; ++k ) {
+        t [ k ] = p;
+        p       = mul_mod_p<T, Poly> ( p, p );
+    }
+    return t;
+}
+
+constexpr std::array<std::uint32_t, 64> crc32c_x2n = make_x2n_table<std::uint32_t, crc32c_poly> ( );
+constexpr std::array<std::uint64_t, 64> crc64_x2n  = make_x2n_table<std::uint64_t, crc64_poly> ( );
+
+// crc1_ * x ^ ( 8 * len2_ ) + crc2_ mod P.
+template<typename T, T Poly>
+T combine ( const T crc1_, const T crc2_, std::uint64_t len2_, const std::array<T, 64> & x2n_ ) noexcept {
+    T p = T { 1 } << ( 8 * sizeof ( T ) - 1 ); // x ^ 0
+    for ( std::size_t k = 3; len2_; len2_ >>= 1, ++k ) {
+        if ( len2_ & 1 ) {
+            p = mul_mod_p<T, Poly> ( x2n_ [ k ], p );
+        }
+    }
+    return mul_mod_p<T, Poly> ( p, crc1_ ) ^ crc2_;
+}
+
+// GF ( 2 ^ 64 ) = GF ( 2 ) [ x ] / ( x ^ 64 + x ^ 4 + x ^ 3 + x + 1 ), bit i is the coefficient of x ^ i.
+inline std::uint64_t gf64_reduce ( const __m128i x_ ) noexcept {
+    // x ^ 64 = x ^ 4 + x ^ 3 + x + 1, the high half is folded in twice.
+    const __m128i p = _mm_cvtsi32_si128 ( 0x1B );
+    const __m128i t = _mm_clmulepi64_si128 ( x_, p, 0x01 ), u = _mm_clmulepi64_si128 ( t, p, 0x01 );
+    return ( std::uint64_t ) _mm_cvtsi128_si64 ( _mm_xor_si128 ( _mm_xor_si128 ( x_, t ), u ) );
+}
+
+inline __m128i clmul ( const std::uint64_t a_, const std::uint64_t b_ ) noexcept {
+    return _mm_clmulepi64_si128 ( _mm_cvtsi64_si128 ( ( long long ) a_ ), _mm_cvtsi64_si128 ( ( long long ) b_ ), 0x00 );
+}
+
+inline std::uint64_t gf64_mul ( const std::uint64_t a_, const std::uint64_t b_ ) noexcept {
+    return gf64_reduce ( clmul ( a_, b_ ) );
+}
+} // namespace
+
+std::uint32_t crc32c ( const void * data_, std::size_t len_, const std::uint32_t crc_ ) noexcept {
+    const std::uint8_t * p = ( const std::uint8_t * ) data_;
+    std::uint64_t s        = ~crc_;
+    if ( len_ >= 64 ) {
+        __m128i r;
+        len_ = fold_to_128 ( p, len_, _mm_cvtsi32_si128 ( ( int ) s ), crc32c_fold, r );
+        s    = _mm_crc32_u64 ( _mm_crc32_u64 ( 0, ( std::uint64_t ) _mm_cvtsi128_si64 ( r ) ), ( std::uint64_t ) _mm_extract_epi64 ( r, 1 ) );
+    }
+    for ( ; len_ >= 8; p += 8, len_ -= 8 ) {
+        s = _mm_crc32_u64 ( s, load64 ( p ) );
+    }
+    for ( ; len_; --len_ ) {
+        s = _mm_crc32_u8 ( ( std::uint32_t ) s, *p++ );
+    }
+    return ~( std::uint32_t ) s;
+}
+
+std::uint64_t crc64 ( const void * data_, std::size_t len_, const std::uint64_t crc_ ) noexcept {
+    const std::uint8_t * p = ( const std::uint8_t * ) data_;
+    std::uint64_t s        = ~crc_;
+    if ( len_ >= 64 ) {
+        __m128i r;
+        alignas ( 16 ) std::uint8_t b [ 16 ];
+        len_ = fold_to_128 ( p, len_, _mm_cvtsi64_si128 ( ( long long ) s ), crc64_fold, r );
+        _mm_store_si128 ( ( __m128i * ) b, r );
+        s = crc64_bytes ( 0, b, 16 );
+    }
+    return ~crc64_bytes ( s, p, len_ );
+}
+
+std::uint32_t crc_combine ( const std::uint32_t crc1_, const std::uint32_t crc2_, const std::uint64_t len2_ ) noexcept {
+    return combine<std::uint32_t, crc32c_poly> ( crc1_, crc2_, len2_, crc32c_x2n );
+}
+
+std::uint64_t crc_combine ( const std::uint64_t crc1_, const std::uint64_t crc2_, const std::uint64_t len2_ ) noexcept {
+    return combine<std::uint64_t, crc64_poly> ( crc1_, crc2_, len2_, crc64_x2n );
+}
+
+std::uint64_t poly_hash ( const void * data_, std::size_t len_, const std::uint64_t key_ ) noexcept {
+    const std::uint8_t * p = ( const std::uint8_t * ) data_;
+    std::uint64_t k [ 9 ] = { 1, key_ };
+    for ( int i = 2; i < 9; ++i ) {
+        k [ i ] = gf64_mul ( k [ i - 1 ], key_ );
+    }
+    const std::uint64_t len = len_;
+    std::uint64_t h = 0;
+    // h = ( h + m0 ) k ^ 8 + m1 k ^ 7 + .. + m7 k, reduced once.
+    const __m128i k87 = _mm_set_epi64x ( ( long long ) k [ 7 ], ( long long ) k [ 8 ] ), k65 = _mm_set_epi64x ( ( long long ) k [ 5 ], ( long long ) k [ 6 ] ),
+                  k43 = _mm_set_epi64x ( ( long long ) k [ 3 ], ( long long ) k [ 4 ] ), k21 = _mm_set_epi64x ( ( long long ) k [ 1 ], ( long long ) k [ 2 ] );
+    for ( ; len_ >= 64; p += 64, len_ -= 64 ) {
+        const __m128i w0 = _mm_xor_si128 ( load ( p ), _mm_cvtsi64_si128 ( ( long long ) h ) ), w1 = load ( p + 16 ), w2 = load ( p + 32 ), w3 = load ( p + 48 );
+        h = gf64_reduce ( _mm_xor_si128 ( _mm_xor_si128 ( fold ( w0, k87 ), fold ( w1, k65 ) ), _mm_xor_si128 ( fold ( w2, k43 ), fold ( w3, k21 ) ) ) );
+    }
+    for ( ; len_ >= 8; p += 8, len_ -= 8 ) {
+        h = gf64_mul ( h ^ load64 ( p ), key_ );
+    }
+    if ( len_ ) {
+        std::uint64_t w = 0;
+        std::memcpy ( &w, p, len_ );
+        h = gf64_mul ( h ^ w, key_ );
+    }
+    // The length tells apart messages that differ in trailing zero bytes only.
+    return gf64_mul ( h ^ len, key_ );
+}
+} // namespace iu
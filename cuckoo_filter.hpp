@@ -0,0 +1,228 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+// Cuckoo filter on 64-bit keys, supports deletion.
+//
+// Partial-key cuckoo hashing, buckets of 4 16-bit fingerprints packed in
+// one 64-bit word. Bucket, fingerprint and alternate bucket derive from a
+// single fmix64 ( key ), i2 = i1 ^ hash ( fingerprint ). A bucket is
+// searched for a fingerprint in one go (SWAR zero-lane test). Up to 95%
+// of the slots can be filled, the false positive rate is about 0.012%.
+// Erasing a key that was never inserted may erase another key.
+class cuckoo_filter {
+
+    static constexpr std::uint64_t lanes_lo = 0x0001'0001'0001'0001, lanes_hi = 0x8000'8000'8000'8000;
+    static constexpr int max_kicks = 500;
+
+    // Batches are hashed and prefetched this many keys ahead of the probes.
+    static constexpr std::size_t batch_size = 32;
+
+    static constexpr std::uint64_t fingerprint ( const std::uint64_t h_ ) noexcept {
+        const std::uint64_t f = h_ >> 48;
+        return f ? f : 1; // 0 marks an empty slot.
+    }
+
+    // Bit 15 of the lane is set for the lanes of b_ equal to f_.
+    static constexpr std::uint64_t match ( const std::uint64_t b_, const std::uint64_t f_ ) noexcept {
+        const std::uint64_t v = b_ ^ ( f_ * lanes_lo );
+        return ( ( ( ( v & ~lanes_hi ) + ~lanes_hi ) | v ) & lanes_hi ) ^ lanes_hi;
+    }
+
+    std::size_t index ( const std::uint64_t h_ ) const noexcept {
+        return ( std::size_t ) h_ & m_mask;
+    }
+    std::size_t alt_index ( const std::size_t i_, const std::uint64_t f_ ) const noexcept {
+        return ( i_ ^ ( std::size_t ) hash ( f_ ) ) & m_mask;
+    }
+
+    bool try_put ( const std::size_t i_, const std::uint64_t f_ ) noexcept {
+        const std::uint64_t e = match ( m_buckets [ i_ ], 0 );
+        if ( e ) {
+            m_buckets [ i_ ] |= f_ << ( tzCount ( e ) - 15 );
+            return true;
+        }
+        return false;
+    }
+
+    bool try_remove ( const std::size_t i_, const std::uint64_t f_ ) noexcept {
+        const std::uint64_t e = match ( m_buckets [ i_ ], f_ );
+        if ( e ) {
+            m_buckets [ i_ ] &= ~( std::uint64_t { 0xFFFF } << ( tzCount ( e ) - 15 ) );
+            return true;
+        }
+        return false;
+    }
+
+    bool contains_hash ( const std::uint64_t h_ ) const noexcept {
+        const std::uint64_t f = fingerprint ( h_ );
+        const std::size_t i1 = index ( h_ ), i2 = alt_index ( i1, f );
+        return ( match ( m_buckets [ i1 ], f ) | match ( m_buckets [ i2 ], f ) ) || ( m_victim_used && m_victim_fingerprint == f && ( m_victim_index == i1 || m_victim_index == i2 ) );
+    }
+
+    public:
+
+    // Sized for n_ keys at a load factor of at most 95%.
+    explicit cuckoo_filter ( const std::size_t n_ ) :
+        m_mask { next_power_2<std::size_t> ( n_ / 4 * 100 / 95 + 2 ) - 1 },
+        m_buckets { new std::uint64_t [ m_mask + 1 ] } {
+        clear ( );
+    }
+
+    // Returns false if the filter is full, the key is kept (in a victim
+    // slot) but no further keys can be inserted.
+    bool insert ( const std::uint64_t key_ ) noexcept {
+        if ( m_victim_used ) {
+            return false;
+        }
+        const std::uint64_t h = fmix64 ( key_ );
+        std::uint64_t f = fingerprint ( h );
+        std::size_t i = index ( h );
+        if ( try_put ( i, f ) || try_put ( alt_index ( i, f ), f ) ) {
+            ++m_size;
+            return true;
+        }
+        // Kick a random fingerprint out, and relocate it to its alternate bucket.
+        i = ( m_rng = fmix64 ( m_rng + h ) ) & 1 ? alt_index ( i, f ) : i;
+        for ( int k = 0; k < max_kicks; ++k ) {
+            const int s = ( int ) ( ( m_rng = fmix64 ( m_rng + 1 ) ) & 3 ) * 16;
+            const std::uint64_t g = ( m_buckets [ i ] >> s ) & 0xFFFF;
+            m_buckets [ i ] ^= ( g ^ f ) << s;
+            f = g;
+            i = alt_index ( i, f );
+            if ( try_put ( i, f ) ) {
+                ++m_size;
+                return true;
+            }
+        }
+        m_victim_used        = true;
+        m_victim_index       = i;
+        m_victim_fingerprint = f;
+        ++m_size;
+        return false;
+    }
+
+    bool contains ( const std::uint64_t key_ ) const noexcept {
+        return contains_hash ( fmix64 ( key_ ) );
+    }
+
+    bool erase ( const std::uint64_t key_ ) noexcept {
+        const std::uint64_t h = fmix64 ( key_ ), f = fingerprint ( h );
+        const std::size_t i1 = index ( h ), i2 = alt_index ( i1, f );
+        if ( try_remove ( i1, f ) || try_remove ( i2, f ) ) {
+            --m_size;
+            // Make room for the victim again.
+            if ( m_victim_used && ( try_put ( m_victim_index, m_victim_fingerprint ) || try_put ( alt_index ( m_victim_index, m_victim_fingerprint ), m_victim_fingerprint ) ) ) {
+                m_victim_used = false;
+            }
+            return true;
+        }
+        if ( m_victim_used && m_victim_fingerprint == f && ( m_victim_index == i1 || m_victim_index == i2 ) ) {
+            m_victim_used = false;
+            --m_size;
+            return true;
+        }
+        return false;
+    }
+
+    // Returns r, the keys_ [ 0, r ) are in the filter. Stops when the filter
+    // is full, the key that fills it is counted (it, or the fingerprint it
+    // kicked out, is kept in the victim slot, nothing is lost), the keys
+    // from there on are not inserted.
+    std::size_t insert_many ( const std::uint64_t * keys_, const std::size_t n_ ) noexcept {
+        for ( std::size_t i = 0; i < n_; i += batch_size ) {
+            const std::size_t m = n_ - i < batch_size ? n_ - i : batch_size;
+            for ( std::size_t j = 0; j < m; ++j ) {
+                _mm_prefetch ( reinterpret_cast<const char *> ( m_buckets.get ( ) + index ( fmix64 ( keys_ [ i + j ] ) ) ), _MM_HINT_T0 );
+            }
+            for ( std::size_t j = 0; j < m; ++j ) {
+                if ( m_victim_used ) {
+                    return i + j;
+                }
+                if ( !insert ( keys_ [ i + j ] ) ) {
+                    return i + j + 1;
+                }
+            }
+        }
+        return n_;
+    }
+
+    // Writes 1 (maybe present) or 0 (absent) to result_ [ i ], returns the number of 1's.
+    std::size_t contains_many ( const std::uint64_t * keys_, const std::size_t n_, std::uint8_t * result_ ) const noexcept {
+        std::uint64_t h [ batch_size ];
+        std::size_t count = 0;
+        for ( std::size_t i = 0; i < n_; i += batch_size ) {
+            const std::size_t m = n_ - i < batch_size ? n_ - i : batch_size;
+            for ( std::size_t j = 0; j < m; ++j ) {
+                h [ j ] = fmix64 ( keys_ [ i + j ] );
+                const std::size_t i1 = index ( h [ j ] );
+                _mm_prefetch ( reinterpret_cast<const char *> ( m_buckets.get ( ) + i1 ), _MM_HINT_T0 );
+                _mm_prefetch ( reinterpret_cast<const char *> ( m_buckets.get ( ) + alt_index ( i1, fingerprint ( h [ j ] ) ) ), _MM_HINT_T0 );
+            }
+            for ( std::size_t j = 0; j < m; ++j ) {
+                const bool r = contains_hash ( h [ j ] );
+                result_ [ i + j ] = ( std::uint8_t ) r;
+                count += r;
+            }
+        }
+        return count;
+    }
+
+    void clear ( ) noexcept {
+        std::memset ( m_buckets.get ( ), 0, ( m_mask + 1 ) * sizeof ( std::uint64_t ) );
+        m_size        = 0;
+        m_victim_used = false;
+    }
+
+    std::size_t size ( ) const noexcept {
+        return m_size;
+    }
+
+    std::size_t capacity ( ) const noexcept {
+        return 4 * ( m_mask + 1 );
+    }
+
+    std::size_t size_in_bytes ( ) const noexcept {
+        return ( m_mask + 1 ) * sizeof ( std::uint64_t );
+    }
+
+    private:
+
+    std::size_t m_mask;
+    std::unique_ptr<std::uint64_t [ ]> m_buckets;
+    std::size_t m_size = 0, m_victim_index = 0;
+    std::uint64_t m_victim_fingerprint = 0, m_rng = 0x0CF3FD1B9997F637;
+    bool m_victim_used = false;
+};
+} // namespace iu
@@ -0,0 +1,267 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <immintrin.h>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+// The partition of key_ (the top radix_bits_ bits of iu::hash ( key_ )),
+// as assigned by hash_partition ().
+inline std::size_t hash_partition_of ( const std::uint64_t key_, const unsigned radix_bits_ ) noexcept {
+    return radix_bits_ ? ( std::size_t ) ( hash ( key_ ) >> ( 64 - radix_bits_ ) ) : 0;
+}
+
+// Up to this fan-out ( 2 ^ bits ) a single pass is the default, above it,
+// the scatter runs out of TLB entries and the write-combining buffers
+// out of L2, and two passes of half the bits each are faster.
+constexpr unsigned hash_partition_max_bits = 10;
+
+namespace detail {
+
+// Software write-combining scatter. Every partition has a cache line
+// sized buffer, a full line is written out with non-temporal stores, so
+// the destination lines are never read (for ownership) and the stores
+// don't evict the input. The lines are aligned on the output, the first
+// and last (partial) line of a partition are written with plain stores.
+template<typename T>
+class swwc_writer {
+
+    static_assert ( std::is_trivially_copyable<T>::value, "T should be trivially copyable" );
+    static_assert ( sizeof ( T ) <= 64 && !( sizeof ( T ) & ( sizeof ( T ) - 1 ) ), "the size of T should be a power of 2, up to 64" );
+
+    static constexpr std::size_t L = 64 / sizeof ( T );
+
+    struct alignas ( 64 ) line {
+        T v [ L ];
+    };
+
+    void write_out ( const std::size_t p_, std::size_t b_, const std::size_t e_ ) noexcept {
+        for ( ; b_ < e_; ++b_ ) {
+            m_out [ b_ ] = m_lines [ p_ ].v [ ( b_ + m_a0 ) & ( L - 1 ) ];
+        }
+    }
+
+    public:
+
+    // start_ [ p ] is the position in out_ of the first element of partition p.
+    void init ( T * out_, const std::size_t * start_, const std::size_t partitions_ ) {
+        assert ( !( ( std::uintptr_t ) out_ % sizeof ( T ) ) );
+        m_out = out_;
+        m_a0  = ( ( std::uintptr_t ) out_ / sizeof ( T ) ) & ( L - 1 );
+        m_lines.resize ( partitions_ );
+        m_start.assign ( start_, start_ + partitions_ );
+        m_pos.assign ( start_, start_ + partitions_ );
+    }
+
+    void put ( const std::size_t p_, const T & v_ ) noexcept {
+        const std::size_t e = m_pos [ p_ ]++, slot = ( e + m_a0 ) & ( L - 1 );
+        m_lines [ p_ ].v [ slot ] = v_;
+        if ( slot == L - 1 ) {
+            if ( e + 1 >= m_start [ p_ ] + L ) {
+                const __m256i * s = reinterpret_cast<const __m256i *> ( m_lines [ p_ ].v );
+                __m256i * d = reinterpret_cast<__m256i *> ( m_out + e + 1 - L );
+                _mm256_stream_si256 ( d, _mm256_load_si256 ( s ) );
+                _mm256_stream_si256 ( d + 1, _mm256_load_si256 ( s + 1 ) );
+            }
+            else {
+                write_out ( p_, m_start [ p_ ], e + 1 );
+            }
+        }
+    }
+
+    // Writes the partially filled lines.
+    void finish ( ) noexcept {
+        for ( std::size_t p = 0; p < m_lines.size ( ); ++p ) {
+            const std::size_t e = m_pos [ p ], k = ( e + m_a0 ) & ( L - 1 );
+            write_out ( p, e - m_start [ p ] > k ? e - k : m_start [ p ], e );
+        }
+        _mm_sfence ( );
+    }
+
+    private:
+
+    std::vector<line> m_lines;
+    T * m_out = nullptr;
+    std::size_t m_a0 = 0;
+    std::vector<std::size_t> m_start, m_pos;
+};
+
+// One pass, partitions [ b_, e_ ) on bits [ 64 - shift_ - bits_, 64 - shift_ )
+// of the hash, into out at the positions in start_.
+template<bool HasPayload, typename P>
+void partition_range ( const std::uint64_t * keys_, const P * payload_, const std::size_t b_, const std::size_t e_, const unsigned shift_, const unsigned bits_, std::uint64_t * keys_out_, P * payload_out_, const std::size_t * start_, swwc_writer<std::uint64_t> & kw_, swwc_writer<P> & pw_ ) {
+    const std::size_t partitions = std::size_t { 1 } << bits_, mask = partitions - 1;
+    kw_.init ( keys_out_, start_, partitions );
+    if constexpr ( HasPayload ) {
+        pw_.init ( payload_out_, start_, partitions );
+    }
+    for ( std::size_t i = b_; i < e_; ++i ) {
+        const std::size_t p = ( std::size_t ) ( hash ( keys_ [ i ] ) >> ( 64 - shift_ - bits_ ) ) & mask;
+        kw_.put ( p, keys_ [ i ] );
+        if constexpr ( HasPayload ) {
+            pw_.put ( p, payload_ [ i ] );
+        }
+    }
+    kw_.finish ( );
+    if constexpr ( HasPayload ) {
+        pw_.finish ( );
+    }
+}
+
+inline void histogram ( const std::uint64_t * keys_, const std::size_t b_, const std::size_t e_, const unsigned shift_, const unsigned bits_, std::size_t * hist_ ) noexcept {
+    const std::size_t mask = ( std::size_t { 1 } << bits_ ) - 1;
+    for ( std::size_t i = b_; i < e_; ++i ) {
+        ++hist_ [ ( std::size_t ) ( hash ( keys_ [ i ] ) >> ( 64 - shift_ - bits_ ) ) & mask ];
+    }
+}
+
+// Parallel radix partitioning pass: per-thread histograms, an (exclusive)
+// prefix sum over partitions and threads, then per-thread scatter.
+template<bool HasPayload, typename P>
+void partition_pass ( const std::uint64_t * keys_, const P * payload_, const std::size_t n_, const unsigned bits_, const unsigned threads_, std::uint64_t * keys_out_, P * payload_out_, std::size_t * offsets_ ) {
+    const std::size_t partitions = std::size_t { 1 } << bits_, chunk = ( n_ + threads_ - 1 ) / threads_;
+    std::vector<std::vector<std::size_t>> start ( threads_, std::vector<std::size_t> ( partitions ) );
+    auto parallel = [ threads_ ] ( auto && f_ ) {
+        std::vector<std::thread> pool;
+        for ( unsigned t = 1; t < threads_; ++t ) {
+            pool.emplace_back ( f_, t );
+        }
+        f_ ( 0u );
+        for ( auto & t : pool ) {
+            t.join ( );
+        }
+    };
+    auto range = [ & ] ( const unsigned t_ ) {
+        const std::size_t b = t_ * chunk < n_ ? t_ * chunk : n_;
+        return std::make_pair ( b, b + chunk < n_ ? b + chunk : n_ );
+    };
+    parallel ( [ & ] ( const unsigned t_ ) {
+        const auto r = range ( t_ );
+        histogram ( keys_, r.first, r.second, 0, bits_, start [ t_ ].data ( ) );
+    } );
+    std::size_t sum = 0;
+    for ( std::size_t p = 0; p < partitions; ++p ) {
+        offsets_ [ p ] = sum;
+        for ( unsigned t = 0; t < threads_; ++t ) {
+            const std::size_t c = start [ t ] [ p ];
+            start [ t ] [ p ] = sum;
+            sum += c;
+        }
+    }
+    offsets_ [ partitions ] = sum;
+    parallel ( [ & ] ( const unsigned t_ ) {
+        const auto r = range ( t_ );
+        swwc_writer<std::uint64_t> kw;
+        swwc_writer<P> pw;
+        partition_range<HasPayload> ( keys_, payload_, r.first, r.second, 0, bits_, keys_out_, payload_out_, start [ t_ ].data ( ), kw, pw );
+    } );
+}
+
+template<bool HasPayload, typename P>
+void hash_partition ( const std::uint64_t * keys_, const P * payload_, const std::size_t n_, const unsigned radix_bits_, unsigned threads_, std::uint64_t * keys_out_, P * payload_out_, std::size_t * offsets_, unsigned passes_ ) {
+    assert ( radix_bits_ > 0 && radix_bits_ <= 24 );
+    threads_ = threads_ ? threads_ : 1;
+    passes_  = passes_ ? passes_ : radix_bits_ > hash_partition_max_bits ? 2 : 1;
+    if ( passes_ == 1 || radix_bits_ < 2 ) {
+        partition_pass<HasPayload> ( keys_, payload_, n_, radix_bits_, threads_, keys_out_, payload_out_, offsets_ );
+        return;
+    }
+    // Two passes, on the high and the low half of the radix bits. The
+    // first pass partitions into the output, the second pass copies the
+    // first level partitions, one at a time, into a (cache resident)
+    // scratch buffer and partitions them from there back into the output.
+    const unsigned bits_1 = ( radix_bits_ + 1 ) / 2, bits_2 = radix_bits_ - bits_1;
+    const std::size_t partitions_1 = std::size_t { 1 } << bits_1, partitions_2 = std::size_t { 1 } << bits_2;
+    std::vector<std::size_t> offsets_1 ( partitions_1 + 1 );
+    partition_pass<HasPayload> ( keys_, payload_, n_, bits_1, threads_, keys_out_, payload_out_, offsets_1.data ( ) );
+    std::atomic<std::size_t> next { 0 };
+    auto worker = [ & ] ( ) {
+        swwc_writer<std::uint64_t> kw;
+        swwc_writer<P> pw;
+        std::vector<std::size_t> hist ( partitions_2 );
+        std::vector<std::uint64_t> keys_tmp;
+        std::vector<std::conditional_t<HasPayload, P, char>> payload_tmp;
+        for ( std::size_t q = next++; q < partitions_1; q = next++ ) {
+            const std::size_t b = offsets_1 [ q ], m = offsets_1 [ q + 1 ] - b;
+            keys_tmp.assign ( keys_out_ + b, keys_out_ + b + m );
+            if constexpr ( HasPayload ) {
+                payload_tmp.assign ( payload_out_ + b, payload_out_ + b + m );
+            }
+            std::fill ( hist.begin ( ), hist.end ( ), 0 );
+            histogram ( keys_tmp.data ( ), 0, m, bits_1, bits_2, hist.data ( ) );
+            std::size_t * o = offsets_ + q * partitions_2, sum = b;
+            for ( std::size_t p = 0; p < partitions_2; ++p ) {
+                o [ p ] = sum;
+                sum += hist [ p ];
+            }
+            partition_range<HasPayload> ( keys_tmp.data ( ), ( const P * ) payload_tmp.data ( ), 0, m, bits_1, bits_2, keys_out_, payload_out_, o, kw, pw );
+        }
+    };
+    std::vector<std::thread> pool;
+    for ( unsigned t = 1; t < threads_; ++t ) {
+        pool.emplace_back ( worker );
+    }
+    worker ( );
+    for ( auto & t : pool ) {
+        t.join ( );
+    }
+    offsets_ [ std::size_t { 1 } << radix_bits_ ] = n_;
+}
+} // namespace detail
+
+// Radix partitioning of n_ keys (and their payload) on the top radix_bits_
+// bits of iu::hash ( key ), for parallel hash joins and aggregation.
+//
+// Partition p ends up in [ offsets_ [ p ], offsets_ [ p + 1 ] ) of
+// keys_out_ and payload_out_, offsets_ holds 2 ^ radix_bits_ + 1 entries.
+// Each pass builds per-thread histograms, takes the prefix sum, then each
+// thread scatters its share of the input through write-combining buffers
+// with non-temporal stores. passes_ is 1 or 2 (0 picks 2 above
+// hash_partition_max_bits), with 2 passes the partitions of the first
+// are partitioned again, each by a single thread, through a scratch
+// buffer the size of a first level partition. Within a partition the
+// input order is kept. The payload type should have a power of 2 size,
+// up to 64 bytes.
+template<typename P>
+void hash_partition ( const std::uint64_t * keys_, const P * payload_, const std::size_t n_, const unsigned radix_bits_, const unsigned threads_, std::uint64_t * keys_out_, P * payload_out_, std::size_t * offsets_, const unsigned passes_ = 0 ) {
+    detail::hash_partition<true> ( keys_, payload_, n_, radix_bits_, threads_, keys_out_, payload_out_, offsets_, passes_ );
+}
+
+// Keys only.
+inline void hash_partition ( const std::uint64_t * keys_, const std::size_t n_, const unsigned radix_bits_, const unsigned threads_, std::uint64_t * keys_out_, std::size_t * offsets_, const unsigned passes_ = 0 ) {
+    detail::hash_partition<false, std::uint64_t> ( keys_, nullptr, n_, radix_bits_, threads_, keys_out_, nullptr, offsets_, passes_ );
+}
+} // namespace iu
@@ -0,0 +1,525 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <immintrin.h>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+// Open addressing hash map/set for 32- and 64-bit unsigned integer keys.
+//
+// As iu::hash () is a bijection, the table stores hash ( key ) instead
+// of the key, probing compares the stored hash directly and the key is
+// recovered with iu::unhash () on iteration. The layout follows the
+// SwissTable design: one control byte per slot (empty, deleted or the
+// low 7 bits of the hash), probed 16 slots at a time with SSE2, the
+// hashes and the values live in separate arrays. The maximum load
+// factor is 7/8.
+
+namespace detail {
+
+template<typename K, typename V>
+class int_table {
+
+    static_assert ( std::is_same<K, std::uint32_t>::value || std::is_same<K, std::uint64_t>::value, "K should be std::uint32_t or std::uint64_t" );
+
+    protected:
+
+    using ctrl_type = std::int8_t;
+
+    static constexpr ctrl_type empty_ctrl = -128, deleted_ctrl = -2;
+    static constexpr std::size_t group_size = 16, npos = ~std::size_t { 0 };
+    static constexpr bool has_values = !std::is_void<V>::value;
+
+    using value_storage = std::conditional_t<has_values, V, char>;
+
+    struct group {
+
+        __m128i m_ctrl;
+
+        explicit group ( const ctrl_type * p_ ) noexcept : m_ctrl { _mm_loadu_si128 ( reinterpret_cast<const __m128i *> ( p_ ) ) } { }
+
+        std::uint32_t match ( const ctrl_type h2_ ) const noexcept {
+            return ( std::uint32_t ) _mm_movemask_epi8 ( _mm_cmpeq_epi8 ( m_ctrl, _mm_set1_epi8 ( h2_ ) ) );
+        }
+        std::uint32_t match_empty ( ) const noexcept {
+            return match ( empty_ctrl );
+        }
+        // Empty and deleted control bytes have the sign bit set.
+        std::uint32_t match_empty_or_deleted ( ) const noexcept {
+            return ( std::uint32_t ) _mm_movemask_epi8 ( m_ctrl );
+        }
+    };
+
+    static constexpr ctrl_type h2 ( const K h_ ) noexcept {
+        return ( ctrl_type ) ( h_ & K { 0x7F } );
+    }
+    static constexpr std::size_t h1 ( const K h_ ) noexcept {
+        return ( std::size_t ) ( h_ >> 7 );
+    }
+
+    public:
+
+    using key_type  = K;
+    using size_type = std::size_t;
+
+    int_table ( ) noexcept = default;
+
+    int_table ( const int_table & o_ ) {
+        if ( o_.m_size ) {
+            allocate ( o_.m_capacity );
+            std::memcpy ( m_ctrl.get ( ), o_.m_ctrl.get ( ), m_capacity );
+            std::memcpy ( m_hashes.get ( ), o_.m_hashes.get ( ), m_capacity * sizeof ( K ) );
+            if constexpr ( has_values ) {
+                for ( std::size_t i = 0; i < m_capacity; ++i ) {
+                    if ( m_ctrl [ i ] >= 0 ) {
+                        ::new ( m_values + i ) V ( o_.m_values [ i ] );
+                    }
+                }
+            }
+            m_size        = o_.m_size;
+            m_growth_left = o_.m_growth_left;
+        }
+    }
+
+    int_table ( int_table && o_ ) noexcept {
+        swap ( o_ );
+    }
+
+    ~int_table ( ) noexcept {
+        destroy_values ( );
+        deallocate_values ( );
+    }
+
+    int_table & operator = ( const int_table & o_ ) {
+        if ( this != &o_ ) {
+            int_table tmp ( o_ );
+            swap ( tmp );
+        }
+        return *this;
+    }
+
+    int_table & operator = ( int_table && o_ ) noexcept {
+        int_table tmp ( std::move ( o_ ) );
+        swap ( tmp );
+        return *this;
+    }
+
+    void swap ( int_table & o_ ) noexcept {
+        std::swap ( m_ctrl, o_.m_ctrl );
+        std::swap ( m_hashes, o_.m_hashes );
+        std::swap ( m_values, o_.m_values );
+        std::swap ( m_capacity, o_.m_capacity );
+        std::swap ( m_size, o_.m_size );
+        std::swap ( m_growth_left, o_.m_growth_left );
+    }
+
+    size_type size ( ) const noexcept {
+        return m_size;
+    }
+    bool empty ( ) const noexcept {
+        return !m_size;
+    }
+    size_type capacity ( ) const noexcept {
+        return m_capacity;
+    }
+
+    bool contains ( const K key_ ) const noexcept {
+        return find_slot ( iu::hash ( key_ ) ) != npos;
+    }
+
+    size_type erase ( const K key_ ) noexcept {
+        const std::size_t slot = find_slot ( iu::hash ( key_ ) );
+        if ( slot == npos ) {
+            return 0;
+        }
+        erase_slot ( slot );
+        return 1;
+    }
+
+    void clear ( ) noexcept {
+        destroy_values ( );
+        if ( m_capacity ) {
+            std::memset ( m_ctrl.get ( ), empty_ctrl, m_capacity );
+        }
+        m_size        = 0;
+        m_growth_left = max_load ( m_capacity );
+    }
+
+    // Makes room for at least n_ elements without rehashing.
+    void reserve ( const size_type n_ ) {
+        if ( n_ > m_size + m_growth_left ) {
+            rehash ( capacity_for ( n_ ) );
+        }
+    }
+
+    protected:
+
+    static constexpr std::size_t max_load ( const std::size_t capacity_ ) noexcept {
+        return capacity_ - capacity_ / 8;
+    }
+
+    static std::size_t capacity_for ( const std::size_t n_ ) noexcept {
+        std::size_t c = group_size;
+        while ( max_load ( c ) < n_ ) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    std::size_t group_mask ( ) const noexcept {
+        return m_capacity / group_size - 1;
+    }
+
+    // Probes whole (aligned) groups, triangular steps visit every group.
+    std::size_t find_slot ( const K h_ ) const noexcept {
+        if ( !m_capacity ) {
+            return npos;
+        }
+        const ctrl_type c = h2 ( h_ );
+        const std::size_t mask = group_mask ( );
+        std::size_t g = h1 ( h_ ) & mask;
+        for ( std::size_t step = 1;; ++step ) {
+            const group grp ( m_ctrl.get ( ) + g * group_size );
+            for ( std::uint32_t m = grp.match ( c ); m; m &= m - 1 ) {
+                const std::size_t slot = g * group_size + tzCount ( m );
+                if ( m_hashes [ slot ] == h_ ) {
+                    return slot;
+                }
+            }
+            if ( grp.match_empty ( ) ) {
+                return npos;
+            }
+            g = ( g + step ) & mask;
+        }
+    }
+
+    std::size_t find_non_full ( const K h_ ) const noexcept {
+        const std::size_t mask = group_mask ( );
+        std::size_t g = h1 ( h_ ) & mask;
+        for ( std::size_t step = 1;; ++step ) {
+            const std::uint32_t m = group ( m_ctrl.get ( ) + g * group_size ).match_empty_or_deleted ( );
+            if ( m ) {
+                return g * group_size + tzCount ( m );
+            }
+            g = ( g + step ) & mask;
+        }
+    }
+
+    // Returns the slot of h_ and whether it was newly claimed, the value
+    // of a newly claimed slot is not yet constructed.
+    std::pair<std::size_t, bool> claim ( const K h_ ) {
+        std::size_t slot = find_slot ( h_ );
+        if ( slot != npos ) {
+            return { slot, false };
+        }
+        if ( !m_growth_left ) {
+            // Grow, or just drop the tombstones if at most half full.
+            rehash ( m_size * 2 + 2 > max_load ( m_capacity ) ? capacity_for ( m_size * 2 + 2 ) : m_capacity );
+        }
+        slot = find_non_full ( h_ );
+        m_growth_left -= m_ctrl [ slot ] == empty_ctrl;
+        m_ctrl [ slot ]   = h2 ( h_ );
+        m_hashes [ slot ] = h_;
+        ++m_size;
+        return { slot, true };
+    }
+
+    void erase_slot ( const std::size_t slot_ ) noexcept {
+        if constexpr ( has_values ) {
+            m_values [ slot_ ].~V ( );
+        }
+        // If the group still has an empty slot, no probe sequence has
+        // ever passed through it, so the slot can become empty again.
+        if ( group ( m_ctrl.get ( ) + ( slot_ & ~( group_size - 1 ) ) ).match_empty ( ) ) {
+            m_ctrl [ slot_ ] = empty_ctrl;
+            ++m_growth_left;
+        }
+        else {
+            m_ctrl [ slot_ ] = deleted_ctrl;
+        }
+        --m_size;
+    }
+
+    // Re-inserts the stored hashes as is, nothing needs to be re-hashed.
+    void rehash ( const std::size_t capacity_ ) {
+        int_table tmp;
+        tmp.allocate ( capacity_ );
+        for ( std::size_t i = 0; i < m_capacity; ++i ) {
+            if ( m_ctrl [ i ] >= 0 ) {
+                const K h = m_hashes [ i ];
+                const std::size_t slot = tmp.find_non_full ( h );
+                tmp.m_ctrl [ slot ]   = h2 ( h );
+                tmp.m_hashes [ slot ] = h;
+                if constexpr ( has_values ) {
+                    ::new ( tmp.m_values + slot ) V ( std::move ( m_values [ i ] ) );
+                    m_values [ i ].~V ( );
+                }
+            }
+        }
+        tmp.m_size        = m_size;
+        tmp.m_growth_left = max_load ( capacity_ ) - m_size;
+        m_size            = 0;
+        swap ( tmp );
+    }
+
+    void allocate ( const std::size_t capacity_ ) {
+        assert ( is_power_2 ( capacity_ ) && capacity_ >= group_size );
+        m_ctrl.reset ( new ctrl_type [ capacity_ ] );
+        m_hashes.reset ( new K [ capacity_ ] );
+        if constexpr ( has_values ) {
+            m_values = std::allocator<V> ( ).allocate ( capacity_ );
+        }
+        std::memset ( m_ctrl.get ( ), empty_ctrl, capacity_ );
+        m_capacity    = capacity_;
+        m_growth_left = max_load ( capacity_ );
+    }
+
+    void destroy_values ( ) noexcept {
+        if constexpr ( has_values && !std::is_trivially_destructible<V>::value ) {
+            for ( std::size_t i = 0; m_size && i < m_capacity; ++i ) {
+                if ( m_ctrl [ i ] >= 0 ) {
+                    m_values [ i ].~V ( );
+                }
+            }
+        }
+    }
+
+    void deallocate_values ( ) noexcept {
+        if constexpr ( has_values ) {
+            if ( m_values ) {
+                std::allocator<V> ( ).deallocate ( m_values, m_capacity );
+            }
+        }
+    }
+
+    std::size_t next_full ( std::size_t i_ ) const noexcept {
+        while ( i_ < m_capacity && m_ctrl [ i_ ] < 0 ) {
+            ++i_;
+        }
+        return i_;
+    }
+
+    std::unique_ptr<ctrl_type [ ]> m_ctrl;
+    std::unique_ptr<K [ ]> m_hashes;
+    value_storage * m_values = nullptr;
+    std::size_t m_capacity = 0, m_size = 0, m_growth_left = 0;
+};
+} // namespace detail
+
+template<typename K, typename V>
+class int_map : public detail::int_table<K, V> {
+
+    using base = detail::int_table<K, V>;
+
+    template<bool Const>
+    class iterator_impl {
+
+        friend class int_map;
+        friend class iterator_impl<!Const>;
+
+        using table_pointer = std::conditional_t<Const, const int_map *, int_map *>;
+
+        table_pointer m_table;
+        std::size_t m_slot;
+
+        iterator_impl ( table_pointer t_, const std::size_t s_ ) noexcept : m_table { t_ }, m_slot { s_ } { }
+
+        public:
+
+        using mapped_reference = std::conditional_t<Const, const V &, V &>;
+        using reference        = std::pair<K, mapped_reference>;
+
+        iterator_impl ( ) noexcept = default;
+
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        iterator_impl ( const iterator_impl<false> & o_ ) noexcept : m_table { o_.m_table }, m_slot { o_.m_slot } { }
+
+        K key ( ) const noexcept {
+            return iu::unhash ( m_table->m_hashes [ m_slot ] );
+        }
+        mapped_reference value ( ) const noexcept {
+            return m_table->m_values [ m_slot ];
+        }
+        reference operator * ( ) const noexcept {
+            return { key ( ), value ( ) };
+        }
+
+        iterator_impl & operator ++ ( ) noexcept {
+            m_slot = m_table->next_full ( m_slot + 1 );
+            return *this;
+        }
+
+        bool operator == ( const iterator_impl & rhs_ ) const noexcept {
+            return m_slot == rhs_.m_slot;
+        }
+        bool operator != ( const iterator_impl & rhs_ ) const noexcept {
+            return m_slot != rhs_.m_slot;
+        }
+    };
+
+    public:
+
+    using mapped_type    = V;
+    using iterator       = iterator_impl<false>;
+    using const_iterator = iterator_impl<true>;
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace ( const K key_, Args &&... args_ ) {
+        const auto [ slot, claimed ] = base::claim ( iu::hash ( key_ ) );
+        if ( claimed ) {
+            ::new ( base::m_values + slot ) V ( std::forward<Args> ( args_ )... );
+        }
+        return { iterator ( this, slot ), claimed };
+    }
+
+    std::pair<iterator, bool> insert ( const K key_, const V & value_ ) {
+        return emplace ( key_, value_ );
+    }
+
+    // Inserts or overwrites.
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign ( const K key_, M && value_ ) {
+        const iterator it = find ( key_ );
+        if ( it != end ( ) ) {
+            it.value ( ) = std::forward<M> ( value_ );
+            return { it, false };
+        }
+        return emplace ( key_, std::forward<M> ( value_ ) );
+    }
+
+    V & operator [ ] ( const K key_ ) {
+        return emplace ( key_ ).first.value ( );
+    }
+
+    iterator find ( const K key_ ) noexcept {
+        const std::size_t slot = base::find_slot ( iu::hash ( key_ ) );
+        return iterator ( this, slot == base::npos ? base::m_capacity : slot );
+    }
+    const_iterator find ( const K key_ ) const noexcept {
+        const std::size_t slot = base::find_slot ( iu::hash ( key_ ) );
+        return const_iterator ( this, slot == base::npos ? base::m_capacity : slot );
+    }
+
+    using base::erase;
+
+    iterator erase ( const const_iterator it_ ) noexcept {
+        base::erase_slot ( it_.m_slot );
+        return iterator ( this, base::next_full ( it_.m_slot + 1 ) );
+    }
+
+    iterator begin ( ) noexcept {
+        return iterator ( this, base::next_full ( 0 ) );
+    }
+    const_iterator begin ( ) const noexcept {
+        return const_iterator ( this, base::next_full ( 0 ) );
+    }
+    const_iterator cbegin ( ) const noexcept {
+        return begin ( );
+    }
+    iterator end ( ) noexcept {
+        return iterator ( this, base::m_capacity );
+    }
+    const_iterator end ( ) const noexcept {
+        return const_iterator ( this, base::m_capacity );
+    }
+    const_iterator cend ( ) const noexcept {
+        return end ( );
+    }
+};
+
+template<typename K>
+class int_set : public detail::int_table<K, void> {
+
+    using base = detail::int_table<K, void>;
+
+    public:
+
+    class const_iterator {
+
+        friend class int_set;
+
+        const int_set * m_table;
+        std::size_t m_slot;
+
+        const_iterator ( const int_set * t_, const std::size_t s_ ) noexcept : m_table { t_ }, m_slot { s_ } { }
+
+        public:
+
+        const_iterator ( ) noexcept = default;
+
+        K operator * ( ) const noexcept {
+            return iu::unhash ( m_table->m_hashes [ m_slot ] );
+        }
+
+        const_iterator & operator ++ ( ) noexcept {
+            m_slot = m_table->next_full ( m_slot + 1 );
+            return *this;
+        }
+
+        bool operator == ( const const_iterator & rhs_ ) const noexcept {
+            return m_slot == rhs_.m_slot;
+        }
+        bool operator != ( const const_iterator & rhs_ ) const noexcept {
+            return m_slot != rhs_.m_slot;
+        }
+    };
+
+    using iterator = const_iterator;
+
+    // Returns true if key_ was inserted, false if it was present already.
+    bool insert ( const K key_ ) {
+        return base::claim ( iu::hash ( key_ ) ).second;
+    }
+
+    const_iterator find ( const K key_ ) const noexcept {
+        const std::size_t slot = base::find_slot ( iu::hash ( key_ ) );
+        return const_iterator ( this, slot == base::npos ? base::m_capacity : slot );
+    }
+
+    using base::erase;
+
+    const_iterator erase ( const const_iterator it_ ) noexcept {
+        base::erase_slot ( it_.m_slot );
+        return const_iterator ( this, base::next_full ( it_.m_slot + 1 ) );
+    }
+
+    const_iterator begin ( ) const noexcept {
+        return const_iterator ( this, base::next_full ( 0 ) );
+    }
+    const_iterator end ( ) const noexcept {
+        return const_iterator ( this, base::m_capacity );
+    }
+};
+} // namespace iu
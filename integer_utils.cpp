@@ -27,6 +27,17 @@
 #define _CRT_RAND_S
 #include <cmath>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+#include <mutex>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <pthread.h>
+#include <sys/random.h>
+#endif
 
 #include "sprp32.h" // https://github.com/wizykowski/miller-rabin
 #include "sprp64.h"
@@ -80,61 +91,364 @@ bool is_prime ( const std::uint64_t n_ ) noexcept {
     return efficient_mr64 ( bases, 7, n_ ) == 1;
 }
 
+// Byte-string hashing.
+
+namespace {
+
+constexpr std::uint64_t hash_k0 = 0xA0761D6478BD642F, hash_k1 = 0xE7037ED1A0B428DB, hash_k2 = 0x8EBC6AF09C88C6E3, hash_k3 = 0x589965CC75374CC3;
+
+inline std::uint64_t read64 ( const std::uint8_t * p_ ) noexcept {
+    std::uint64_t v;
+    std::memcpy ( &v, p_, sizeof ( v ) );
+    return v;
+}
+
+inline std::uint64_t read32 ( const std::uint8_t * p_ ) noexcept {
+    std::uint32_t v;
+    std::memcpy ( &v, p_, sizeof ( v ) );
+    return v;
+}
+
+inline std::uint64_t hash_bytes_init ( const std::uint64_t seed_ ) noexcept {
+    return seed_ ^ mul_fold ( seed_ ^ hash_k0, hash_k1 );
+}
+
+// One 32-byte step, two independent multiply chains.
+inline void hash_bytes_block ( const std::uint8_t * p_, std::uint64_t & s0_, std::uint64_t & s1_ ) noexcept {
+    s0_ = mul_fold ( read64 ( p_ +  0 ) ^ hash_k1, read64 ( p_ +  8 ) ^ s0_ );
+    s1_ = mul_fold ( read64 ( p_ + 16 ) ^ hash_k2, read64 ( p_ + 24 ) ^ s1_ );
+}
+
+// Hashes the last n_ (<= 32) bytes ending at p_ + n_. If len_ > 16, the 16
+// bytes in front of p_ + n_ must be readable (they are, they've either been
+// mixed in already or are part of the tail).
+inline std::uint64_t hash_bytes_tail ( std::uint64_t seed_, const std::uint8_t * p_, std::size_t n_, const std::uint64_t len_ ) noexcept {
+    std::uint64_t a, b;
+    if ( len_ <= 16 ) {
+        if ( len_ >= 4 ) {
+            const std::size_t o = ( len_ >> 3 ) << 2;
+            a = ( read32 ( p_ ) << 32 ) | read32 ( p_ + o );
+            b = ( read32 ( p_ + len_ - 4 ) << 32 ) | read32 ( p_ + len_ - 4 - o );
+        }
+        else if ( len_ ) {
+            a = ( std::uint64_t { p_ [ 0 ] } << 16 ) | ( std::uint64_t { p_ [ len_ >> 1 ] } << 8 ) | p_ [ len_ - 1 ];
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        while ( n_ > 16 ) {
+            seed_ = mul_fold ( read64 ( p_ ) ^ hash_k1, read64 ( p_ + 8 ) ^ seed_ );
+            p_ += 16;
+            n_ -= 16;
+        }
+        a = read64 ( p_ + n_ - 16 );
+        b = read64 ( p_ + n_ - 8 );
+    }
+    return mul_fold ( hash_k3 ^ len_, mul_fold ( a ^ hash_k1, b ^ seed_ ) );
+}
+} // namespace
+
+std::uint64_t hash_bytes ( const void * data_, const std::size_t len_, const std::uint64_t seed_ ) noexcept {
+    const std::uint8_t * p = static_cast<const std::uint8_t *> ( data_ );
+    std::uint64_t seed = hash_bytes_init ( seed_ );
+    std::size_t n = len_;
+    if ( n > 32 ) {
+        std::uint64_t s0 = seed, s1 = seed ^ hash_k3;
+        do {
+            hash_bytes_block ( p, s0, s1 );
+            p += 32;
+            n -= 32;
+        } while ( n > 32 );
+        seed = s0 ^ s1;
+    }
+    return hash_bytes_tail ( seed, p, n, len_ );
+}
+
+hasher::hasher ( const std::uint64_t seed_ ) noexcept {
+    reset ( seed_ );
+}
+
+void hasher::reset ( const std::uint64_t seed_ ) noexcept {
+    m_seed    = hash_bytes_init ( seed_ );
+    m_s0      = m_seed;
+    m_s1      = m_seed ^ hash_k3;
+    m_len     = 0;
+    m_pending = 0;
+}
+
+void hasher::update ( const void * data_, std::size_t len_ ) noexcept {
+    const std::uint8_t * p = static_cast<const std::uint8_t *> ( data_ );
+    m_len += len_;
+    // A full pending block is only mixed in once more bytes follow it.
+    if ( m_pending + len_ <= 32 ) {
+        std::memcpy ( m_buf + 32 + m_pending, p, len_ );
+        m_pending += len_;
+        return;
+    }
+    if ( m_pending ) {
+        const std::size_t fill = 32 - m_pending;
+        std::memcpy ( m_buf + 32 + m_pending, p, fill );
+        p += fill;
+        len_ -= fill;
+        hash_bytes_block ( m_buf + 32, m_s0, m_s1 );
+        std::memcpy ( m_buf, m_buf + 32, 32 );
+    }
+    if ( len_ > 32 ) {
+        do {
+            hash_bytes_block ( p, m_s0, m_s1 );
+            p += 32;
+            len_ -= 32;
+        } while ( len_ > 32 );
+        std::memcpy ( m_buf, p - 32, 32 );
+    }
+    std::memcpy ( m_buf + 32, p, len_ );
+    m_pending = len_;
+}
+
+std::uint64_t hasher::finish ( ) const noexcept {
+    return hash_bytes_tail ( m_len > 32 ? m_s0 ^ m_s1 : m_seed, m_buf + 32, m_pending, m_len );
+}
+
+
+namespace {
+
+// Exact conversions between u64 lanes below 2 ^ 52 and doubles.
+inline __m256d u52_to_pd ( const __m256i x_ ) noexcept {
+    const __m256i magic = _mm256_castpd_si256 ( _mm256_set1_pd ( 4503599627370496.0 ) ); // 2 ^ 52
+    return _mm256_sub_pd ( _mm256_castsi256_pd ( _mm256_or_si256 ( x_, magic ) ), _mm256_set1_pd ( 4503599627370496.0 ) );
+}
+inline __m256i pd_to_u52 ( const __m256d x_ ) noexcept {
+    return _mm256_xor_si256 ( _mm256_castpd_si256 ( _mm256_add_pd ( x_, _mm256_set1_pd ( 4503599627370496.0 ) ) ), _mm256_castpd_si256 ( _mm256_set1_pd ( 4503599627370496.0 ) ) );
+}
+
+// 2 x 4 jump_hash () loops, run side by side to hide the latency of the
+// divides. b + 1 and j are kept as doubles, the arithmetic is the same as
+// in the scalar version, so are the results.
+inline void jump_hash_8 ( const std::uint64_t * keys_, const __m256d buckets_, std::uint32_t * out_ ) noexcept {
+    const __m256i mul = _mm256_set1_epi64x ( 2862933555777941757LL ), one = _mm256_set1_epi64x ( 1 );
+    const __m256d two_31 = _mm256_set1_pd ( 2147483648.0 ), one_pd = _mm256_set1_pd ( 1.0 );
+    __m256i key [ 2 ];
+    __m256d b [ 2 ], j [ 2 ], active [ 2 ];
+    for ( int l = 0; l < 2; ++l ) {
+        key [ l ]    = fmix64 ( _mm256_loadu_si256 ( ( const __m256i * ) ( keys_ + 4 * l ) ) );
+        b [ l ]      = _mm256_setzero_pd ( );
+        j [ l ]      = _mm256_setzero_pd ( );
+        active [ l ] = _mm256_cmp_pd ( j [ l ], buckets_, _CMP_LT_OQ );
+    }
+    do {
+        for ( int l = 0; l < 2; ++l ) {
+            b [ l ]   = _mm256_blendv_pd ( b [ l ], j [ l ], active [ l ] );
+            key [ l ] = _mm256_add_epi64 ( mullo_epi64 ( key [ l ], mul ), one );
+            const __m256d r = u52_to_pd ( _mm256_add_epi64 ( _mm256_srli_epi64 ( key [ l ], 33 ), one ) );
+            j [ l ]      = _mm256_floor_pd ( _mm256_mul_pd ( _mm256_add_pd ( b [ l ], one_pd ), _mm256_div_pd ( two_31, r ) ) );
+            active [ l ] = _mm256_and_pd ( active [ l ], _mm256_cmp_pd ( j [ l ], buckets_, _CMP_LT_OQ ) );
+        }
+    } while ( _mm256_movemask_pd ( _mm256_or_pd ( active [ 0 ], active [ 1 ] ) ) );
+    // Gather the low 32 bits of the lanes.
+    const __m256i idx = _mm256_setr_epi32 ( 0, 2, 4, 6, 1, 3, 5, 7 );
+    _mm_storeu_si128 ( ( __m128i * ) out_, _mm256_castsi256_si128 ( _mm256_permutevar8x32_epi32 ( pd_to_u52 ( b [ 0 ] ), idx ) ) );
+    _mm_storeu_si128 ( ( __m128i * ) ( out_ + 4 ), _mm256_castsi256_si128 ( _mm256_permutevar8x32_epi32 ( pd_to_u52 ( b [ 1 ] ), idx ) ) );
+}
+} // namespace
+
+void jump_hash_batch ( const std::uint64_t * keys_, const std::size_t n_, const std::uint32_t buckets_, std::uint32_t * out_ ) noexcept {
+    assert ( buckets_ > 0 );
+    const __m256d buckets = _mm256_set1_pd ( ( double ) buckets_ );
+    std::size_t i = 0;
+    for ( ; i + 8 <= n_; i += 8 ) {
+        jump_hash_8 ( keys_ + i, buckets, out_ + i );
+    }
+    for ( ; i < n_; ++i ) {
+        out_ [ i ] = jump_hash ( keys_ [ i ], buckets_ );
+    }
+}
+
+
 // Random.
 
 // Seeding.
 
-#if defined ( __AVX2__ ) && defined ( __GNUC__ )
-void seed ( std::uint32_t & s_ ) noexcept {
-    _rdseed32_step ( &s_ );
-}
+namespace {
 
-void seed ( std::uint64_t & s_ ) noexcept {
-    _rdseed64_step ( &s_ );
+// Fills p_ [ 0, n_ ) from the os, false if that fails.
+bool os_entropy ( std::uint64_t * p_, const std::size_t n_ ) noexcept {
+#ifdef _WIN32
+    // rand_s ( ) is RtlGenRandom ( ), no system call.
+    std::uint32_t * p = reinterpret_cast<std::uint32_t *> ( p_ );
+    for ( std::size_t i = 0; i < 2 * n_; ++i ) {
+        if ( rand_s ( p + i ) ) {
+            return false;
+        }
+    }
+    return true;
+#else
+    std::uint8_t * p = reinterpret_cast<std::uint8_t *> ( p_ );
+    std::size_t n    = n_ * sizeof ( std::uint64_t );
+    while ( n ) {
+        // Reads of up to 256 bytes are never short, longer ones can be
+        // interrupted by a signal.
+        const ssize_t r = getrandom ( p, n, 0 );
+        if ( r < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            return false;
+        }
+        p += r;
+        n -= ( std::size_t ) r;
+    }
+    return true;
+#endif
 }
+
+#if defined ( _MSC_VER ) || defined ( __RDSEED__ )
+bool has_rdseed ( ) noexcept {
+#ifdef _MSC_VER
+    int r [ 4 ];
+    __cpuidex ( r, 7, 0 );
+    return r [ 1 ] & ( 1 << 18 );
 #else
-#ifdef _WIN32
-void seed ( std::uint32_t & s_ ) noexcept {
-    rand_s ( &s_ );
+    return __builtin_cpu_supports ( "rdseed" );
+#endif
 }
 
-void seed ( std::uint64_t & s_ ) noexcept {
-    rand_s ( ( ( std::uint32_t * ) & s_ ) + 0 );
-    rand_s ( ( ( std::uint32_t * ) & s_ ) + 1 );
+// rdseed fails (carry clear) while the entropy conditioner is drained,
+// retry, with a pause in between.
+bool rdseed64 ( std::uint64_t & s_ ) noexcept {
+    static const bool supported = has_rdseed ( );
+    for ( int i = 0; supported && i < 128; ++i ) {
+        unsigned long long s;
+        if ( _rdseed64_step ( &s ) ) {
+            s_ = s;
+            return true;
+        }
+        _mm_pause ( );
+    }
+    return false;
 }
 #else
+bool rdseed64 ( std::uint64_t & ) noexcept {
+    return false;
 }
-#include <random>
-namespace iu {
+#endif
+
+// Entropy is read in blocks of 64 words, every word of entropy is mixed
+// into a splitmix64 state, which then gives 16 words of seed material.
+class entropy_pool {
+
+    static constexpr std::size_t block_size = 64, words_per_reseed = 16;
+
+    void refill ( ) noexcept {
+        if ( !os_entropy ( m_entropy, block_size ) ) {
+            for ( std::uint64_t & w : m_entropy ) {
+                if ( !rdseed64 ( w ) ) {
+                    // Nothing better left.
+                    w = ( std::uint64_t ) std::chrono::high_resolution_clock::now ( ).time_since_epoch ( ).count ( ) ^ ( std::uint64_t ) &w;
+                }
+            }
+        }
+        m_next = 0;
+    }
+
+    entropy_pool ( ) noexcept {
+#ifndef _WIN32
+        // After a fork ( ), the child drops the buffered entropy and reseeds,
+        // parent and child don't hand out the same seeds. The handlers keep
+        // the mutex from being copied locked.
+        pthread_atfork ( [ ] ( ) { instance ( ).m_mutex.lock ( ); }, [ ] ( ) { instance ( ).m_mutex.unlock ( ); },
+                         [ ] ( ) {
+                             entropy_pool & p = instance ( );
+                             p.m_next         = block_size;
+                             p.m_left         = 0;
+                             p.m_mutex.unlock ( );
+                         } );
+#endif
+    }
+
+    public:
+
+    static entropy_pool & instance ( ) noexcept {
+        static entropy_pool pool;
+        return pool;
+    }
+
+    void fill ( std::uint64_t * s_, const std::size_t n_ ) noexcept {
+        std::lock_guard<std::mutex> lock ( m_mutex );
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            if ( !m_left ) {
+                if ( m_next == block_size ) {
+                    refill ( );
+                }
+                m_rng  = sax::splitmix64 ( m_rng ( ) ^ m_entropy [ m_next++ ] );
+                m_left = words_per_reseed;
+            }
+            --m_left;
+            s_ [ i ] = m_rng ( );
+        }
+    }
+
+    private:
+
+    std::mutex m_mutex;
+    sax::splitmix64 m_rng;
+    std::uint64_t m_entropy [ block_size ];
+    std::size_t m_next = block_size, m_left = 0;
+};
+} // namespace
+
+void seed ( std::uint64_t * s_, const std::size_t n_ ) noexcept {
+    entropy_pool::instance ( ).fill ( s_, n_ );
+}
+
 void seed ( std::uint32_t & s_ ) noexcept {
-    s_ = [ ] ( ) { std::random_device rdev; return ( std::uint32_t ) rdev ( ); } ( );
+    std::uint64_t s;
+    seed ( &s, 1 );
+    s_ = ( std::uint32_t ) s;
 }
 
 void seed ( std::uint64_t & s_ ) noexcept {
-    if constexpr ( std::is_same<typename std::random_device::result_type, std::uint64_t>::value ) {
-        s_ = [ ] ( ) { std::random_device rdev; return ( std::uint32_t ) rdev ( ); } ( );
-    }
-    else {
-        auto _seed = [ ] ( ) { std::random_device rdev; return ( std::uint64_t ) rdev ( ); };
-        s_ = ( _seed ( ) << 32 ) & _seed ( );
-    }
+    seed ( &s_, 1 );
 }
-#endif
-#endif
 
 std::uintmax_t seed ( ) noexcept {
-    std::uintmax_t r;
-    iu::seed ( r );
+    std::uint64_t r;
+    seed ( &r, 1 );
     return r;
 }
 
 
 // #ifdef __AVX2__
 
+namespace {
+
+// _mm256_rli_si256 ( a_, N ) for 0 < N < 64 (a rotate of the whole 256-bit
+// word), inlined with immediate shifts.
+template<int N>
+inline __m256i rotl256 ( const __m256i a_ ) noexcept {
+    return _mm256_or_si256 ( _mm256_slli_epi64 ( a_, N ), _mm256_permute4x64_epi64 ( _mm256_srli_epi64 ( a_, 64 - N ), _MM_SHUFFLE ( 2, 1, 0, 3 ) ) );
+}
+
+inline __m256i xoroshiro4x_step ( __m256i & s0_, __m256i & s1_ ) noexcept {
+    const __m256i r = _mm256_add_epi64 ( s0_, s1_ );
+    s1_ = _mm256_xor_si256 ( s1_, s0_ );
+    s0_ = _mm256_xor_si256 ( _mm256_xor_si256 ( rotl256<24> ( s0_ ), s1_ ), _mm256_slli_epi64 ( s1_, 16 ) );
+    s1_ = rotl256<37> ( s1_ );
+    return r;
+}
+
+// The lanes in the order operator ( ) returns them, 3, 0, 1, 2.
+inline __m256i xoroshiro4x_order ( const __m256i r_ ) noexcept {
+    return _mm256_permute4x64_epi64 ( r_, _MM_SHUFFLE ( 2, 1, 0, 3 ) );
+}
+} // namespace
+
 xoroshiro4x128plusavx::xoroshiro4x128plusavx ( ) noexcept {
-    m_s0 = _mm256_set_epi64x ( iu::seed ( ), iu::seed ( ), iu::seed ( ), iu::seed ( ) );
-    m_s1 = _mm256_set_epi64x ( iu::seed ( ), iu::seed ( ), iu::seed ( ), iu::seed ( ) );
-    m_i  = start_case ( );
+    std::uint64_t s [ 8 ];
+    iu::seed ( s, 8 );
+    seed ( s );
 }
 
 xoroshiro4x128plusavx::xoroshiro4x128plusavx ( const std::uint64_t s_ ) noexcept {
@@ -143,8 +457,16 @@ xoroshiro4x128plusavx::xoroshiro4x128plusavx ( const std::uint64_t s_ ) noexcept
 
 void xoroshiro4x128plusavx::seed ( const std::uint64_t s_ ) noexcept {
     sax::splitmix64 rng ( s_ );
-    m_s0 = _mm256_set_epi64x ( rng ( ), rng ( ), rng ( ), rng ( ) );
-    m_s1 = _mm256_set_epi64x ( rng ( ), rng ( ), rng ( ), rng ( ) );
+    std::uint64_t s [ 8 ];
+    for ( std::uint64_t & w : s ) {
+        w = rng ( );
+    }
+    seed ( s );
+}
+
+void xoroshiro4x128plusavx::seed ( const std::uint64_t * s_ ) noexcept {
+    m_s0 = _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( s_ ) );
+    m_s1 = _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( s_ + 4 ) );
     m_i  = start_case ( );
 }
 
@@ -156,17 +478,103 @@ typename xoroshiro4x128plusavx::result_type xoroshiro4x128plusavx::operator ( )
         default:
         {
             m_i  = 0;
-            m_r  = _mm256_add_epi64 ( m_s0, m_s1 );
-
-            m_s1 = _mm256_xor_si256 ( m_s1, m_s0 );
-            m_s0 = _mm256_xor_si256 ( _mm256_xor_si256 ( _mm256_rli_si256 ( m_s0, 24 ), m_s1 ), _mm256_slli_epi64 ( m_s1, 16 ) );
-            m_s1 = _mm256_rli_si256 ( m_s1, 37 );
+            m_r  = xoroshiro4x_step ( m_s0, m_s1 );
 
             return _mm256_extract_epi64 ( m_r, 3 );
         }
     }
 }
 
+void xoroshiro4x128plusavx::generate ( result_type * out_, std::size_t n_ ) noexcept {
+    // Drain the values left over from the last operator ( ) or generate ( ).
+    for ( ; m_i < start_case ( ) && n_; --n_ ) {
+        *out_++ = ( *this ) ( );
+    }
+    if ( !n_ ) {
+        return;
+    }
+    __m256i s0 = m_s0, s1 = m_s1;
+    __m256i * o = reinterpret_cast<__m256i *> ( out_ );
+    std::size_t v = n_ / 4;
+    // Unaligned stores that don't cross a cache line cost the same as
+    // aligned ones, only a misaligned out_ pays the split stores.
+    for ( ; v >= 4; v -= 4, o += 4 ) {
+        const __m256i r0 = xoroshiro4x_step ( s0, s1 );
+        const __m256i r1 = xoroshiro4x_step ( s0, s1 );
+        const __m256i r2 = xoroshiro4x_step ( s0, s1 );
+        const __m256i r3 = xoroshiro4x_step ( s0, s1 );
+        _mm256_storeu_si256 ( o + 0, xoroshiro4x_order ( r0 ) );
+        _mm256_storeu_si256 ( o + 1, xoroshiro4x_order ( r1 ) );
+        _mm256_storeu_si256 ( o + 2, xoroshiro4x_order ( r2 ) );
+        _mm256_storeu_si256 ( o + 3, xoroshiro4x_order ( r3 ) );
+    }
+    for ( ; v; --v, ++o ) {
+        _mm256_storeu_si256 ( o, xoroshiro4x_order ( xoroshiro4x_step ( s0, s1 ) ) );
+    }
+    // The tail, the rest of the last vector is kept for operator ( ).
+    if ( n_ % 4 ) {
+        m_r = xoroshiro4x_step ( s0, s1 );
+        alignas ( 32 ) result_type r [ 4 ];
+        _mm256_store_si256 ( reinterpret_cast<__m256i *> ( r ), xoroshiro4x_order ( m_r ) );
+        std::memcpy ( o, r, ( n_ % 4 ) * sizeof ( result_type ) );
+        m_i = n_ % 4 - 1;
+    }
+    m_s0 = s0;
+    m_s1 = s1;
+}
+
+namespace {
+
+const detail::gf2_char_poly<512> & xoroshiro4x_char_poly ( ) noexcept {
+    static const detail::gf2_char_poly<512> p ( [ s0 = _mm256_set_epi64x ( 4, 3, 2, 1 ), s1 = _mm256_set1_epi64x ( 0x9E3779B97F4A7C15 ) ] ( ) mutable {
+        const bool r = _mm256_cvtsi256_si32 ( s0 ) & 1;
+        xoroshiro4x_step ( s0, s1 );
+        return r;
+    } );
+    return p;
+}
+
+void xoroshiro4x_jump ( __m256i & s0_, __m256i & s1_, const detail::gf2_poly<512> & j_ ) noexcept {
+    __m256i s0 = _mm256_setzero_si256 ( ), s1 = _mm256_setzero_si256 ( );
+    for ( std::size_t i = 0; i < 512; ++i ) {
+        if ( j_.coefficient ( i ) ) {
+            s0 = _mm256_xor_si256 ( s0, s0_ );
+            s1 = _mm256_xor_si256 ( s1, s1_ );
+        }
+        xoroshiro4x_step ( s0_, s1_ );
+    }
+    s0_ = s0;
+    s1_ = s1;
+}
+} // namespace
+
+void xoroshiro4x128plusavx::jump ( ) noexcept {
+    static const detail::gf2_poly<512> j = xoroshiro4x_char_poly ( ).pow2 ( 256 );
+    xoroshiro4x_jump ( m_s0, m_s1, j );
+    m_i = start_case ( );
+}
+
+void xoroshiro4x128plusavx::long_jump ( ) noexcept {
+    static const detail::gf2_poly<512> j = xoroshiro4x_char_poly ( ).pow2 ( 384 );
+    xoroshiro4x_jump ( m_s0, m_s1, j );
+    m_i = start_case ( );
+}
+
+// Not in xoroshiro_avx512.cpp, that TU may use AVX-512 anywhere.
+bool xoroshiro8x128plusavx512::is_supported ( ) noexcept {
+#ifdef _MSC_VER
+    int r [ 4 ];
+    __cpuid ( r, 1 );
+    if ( !( r [ 2 ] & ( 1 << 27 ) ) || ( _xgetbv ( 0 ) & 0xE6 ) != 0xE6 ) { // osxsave, xmm/ymm/zmm state enabled.
+        return false;
+    }
+    __cpuidex ( r, 7, 0 );
+    return r [ 1 ] & ( 1 << 16 ); // avx512f
+#else
+    return __builtin_cpu_supports ( "avx512f" );
+#endif
+}
+
 void print_bits ( __m256i n ) noexcept { // little-endian
     print_bits ( ( std::uint64_t ) _mm256_extract_epi64 ( n, 3 ) );
     print_bits ( ( std::uint64_t ) _mm256_extract_epi64 ( n, 2 ) );
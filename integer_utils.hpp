@@ -28,15 +28,25 @@
 #endif
 
 #include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
+#include <iterator>
 #include <limits>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <sax/splitmix.hpp> // https://github.com/degski/Sax/blob/master/splitmix.hpp
 
+#include "xoroshiro_jump.hpp"
+
 #ifdef NDEBUG
 #pragma comment ( lib, "integer_utils-s.lib" )
 #else
@@ -48,7 +58,30 @@ namespace iu {
 namespace detail {
 template<typename T>
 using is_string = std::is_base_of<std::basic_string<typename T::value_type>, T>;
+
+// A seed sequence, as std::seed_seq, has generate ( first, last ) on 32-bit words.
+template<typename Sseq, typename = void>
+struct is_seed_seq : std::false_type { };
+template<typename Sseq>
+struct is_seed_seq<Sseq, std::void_t<decltype ( std::declval<Sseq &> ( ).generate ( std::declval<std::uint32_t *> ( ), std::declval<std::uint32_t *> ( ) ) )>> : std::true_type { };
+
+// Fills s_ [ 0, n_ ) from 2 * n_ words of q_, never all zero.
+template<typename Sseq>
+void seed_words ( Sseq & q_, std::uint64_t * s_, const std::size_t n_ ) {
+    std::uint32_t w [ 32 ];
+    std::uint64_t any = 0;
+    for ( std::size_t i = 0; i < n_; i += 16 ) {
+        const std::size_t m = n_ - i < 16 ? n_ - i : 16;
+        q_.generate ( w, w + 2 * m );
+        for ( std::size_t j = 0; j < m; ++j ) {
+            any |= s_ [ i + j ] = ( std::uint64_t { w [ 2 * j + 1 ] } << 32 ) | w [ 2 * j ];
+        }
+    }
+    if ( !any ) {
+        s_ [ 0 ] = 1;
+    }
 }
+} // namespace detail
 
 // Greatest Common Denominator.
 template<typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>, std::is_unsigned<T>>>>
@@ -182,14 +215,74 @@ constexpr std::uint64_t hash_64_fnv1a_const ( const char* const str, const std::
     return ( str [ 0 ] == '\0' ) ? value : hash_64_fnv1a_const ( &str [ 1 ], ( value ^ std::uint64_t ( str [ 0 ] ) ) * 0x100000001b3 );
 }
 
-constexpr std::uint32_t hash_32_fnv1a_const ( const std::string & str_, const std::uint32_t value_ = 0x811c9dc5 ) noexcept {
+// The std::string overloads can't be evaluated at compile time, they
+// walk the string one byte at a time, prefer hash_bytes () at run-time.
+inline std::uint32_t hash_32_fnv1a_const ( const std::string & str_, const std::uint32_t value_ = 0x811c9dc5 ) noexcept {
     return hash_32_fnv1a_const ( str_.c_str ( ), value_ );
 }
 
-constexpr std::uint64_t hash_64_fnv1a_const ( const std::string & str_, const std::uint64_t value_ = 0xcbf29ce484222325 ) noexcept {
+inline std::uint64_t hash_64_fnv1a_const ( const std::string & str_, const std::uint64_t value_ = 0xcbf29ce484222325 ) noexcept {
     return hash_64_fnv1a_const ( str_.c_str ( ), value_ );
 }
 
+// Run-time byte-string hashing, consumes 32 bytes per step (in two
+// independent lanes), followed by 16-byte steps for the tail, the last 16
+// bytes are read as two (overlapping if need be) 8-byte words, shorter
+// inputs as 4-byte words or single bytes. Every step is a 64 x 64 -> 128
+// bit multiply, folded (lo ^ hi) to 64 bits.
+std::uint64_t hash_bytes ( const void * data_, const std::size_t len_, const std::uint64_t seed_ = 0 ) noexcept;
+
+inline std::uint64_t hash_bytes ( const std::string & str_, const std::uint64_t seed_ = 0 ) noexcept {
+    return hash_bytes ( str_.data ( ), str_.size ( ), seed_ );
+}
+
+// Incremental version of hash_bytes (), for streamed input. Feeding the
+// same bytes, in any number of chunks, gives the same result as hash_bytes ().
+class hasher {
+
+    public:
+
+    hasher ( const std::uint64_t seed_ = 0 ) noexcept;
+
+    void reset ( const std::uint64_t seed_ = 0 ) noexcept;
+    void update ( const void * data_, std::size_t len_ ) noexcept;
+
+    inline void update ( const std::string & str_ ) noexcept {
+        update ( str_.data ( ), str_.size ( ) );
+    }
+
+    std::uint64_t finish ( ) const noexcept;
+
+    private:
+
+    // The previous (already mixed) 32-byte block is kept in front of the
+    // pending bytes, the tail of hash_bytes () reads back into it.
+    alignas ( 32 ) std::uint8_t m_buf [ 64 ];
+    std::uint64_t m_seed, m_s0, m_s1, m_len;
+    std::size_t m_pending;
+};
+
+// CRC-32C (Castagnoli) and CRC-64/XZ (ECMA-182), pass the CRC of the
+// preceding data as crc_ to continue a CRC. From 64 bytes on, the data is
+// folded with carry-less multiplies (PCLMULQDQ, or VPCLMULQDQ on 4 x 512
+// bits if available at compile time) down to 128 bits, which are reduced
+// with the crc32 instruction (crc32c) or a table (crc64).
+std::uint32_t crc32c ( const void * data_, const std::size_t len_, const std::uint32_t crc_ = 0 ) noexcept;
+std::uint64_t crc64 ( const void * data_, const std::size_t len_, const std::uint64_t crc_ = 0 ) noexcept;
+
+// The CRC of the concatenation A + B, from the CRC's of A and B and the
+// length (in bytes) of B, O ( log len2_ ). Chunks of a file can be
+// checksummed independently (on different threads) and merged.
+std::uint32_t crc_combine ( const std::uint32_t crc1_, const std::uint32_t crc2_, const std::uint64_t len2_ ) noexcept; // crc32c
+std::uint64_t crc_combine ( const std::uint64_t crc1_, const std::uint64_t crc2_, const std::uint64_t len2_ ) noexcept; // crc64
+
+// Polynomial (universal) hash over GF ( 2 ^ 64 ), the data, as 64-bit
+// words m_1 .. m_n, is evaluated as m_1 k ^ n + .. + m_n k at the key k (key_
+// should be random and not 0), two different messages of at most n words
+// collide with a probability of at most ( n + 1 ) / 2 ^ 64. Carry-less
+// multiplies, 8 words per reduction.
+std::uint64_t poly_hash ( const void * data_, const std::size_t len_, const std::uint64_t key_ ) noexcept;
+
 // Integer Hashing.
 constexpr std::uint32_t hash ( std::uint32_t x ) noexcept {
     x = ( ( x >> 16 ) ^ x ) * 0X45D9F3B;
@@ -250,6 +343,210 @@ void hash_combine ( std::uint64_t & seed_, const T & v_ ) noexcept {
     seed_ ^= hasher ( v_ ) + 0x9E3779B9'7F4A7C15 + ( seed_ << 6 ) + ( seed_ >> 2 );
 }
 
+// 64 x 64 -> 128 bit multiply, returns the low half, the high half goes
+// to hi_.
+inline std::uint64_t mul_wide ( const std::uint64_t a_, const std::uint64_t b_, std::uint64_t & hi_ ) noexcept {
+#if defined ( _MSC_VER ) && defined ( _M_X64 )
+    return _umul128 ( a_, b_, &hi_ );
+#elif defined ( __SIZEOF_INT128__ )
+    const unsigned __int128 r = ( unsigned __int128 ) a_ * b_;
+    hi_ = ( std::uint64_t ) ( r >> 64 );
+    return ( std::uint64_t ) r;
+#else
+    const std::uint64_t a0 = a_ & 0xFFFF'FFFF, a1 = a_ >> 32, b0 = b_ & 0xFFFF'FFFF, b1 = b_ >> 32;
+    const std::uint64_t m = a1 * b0 + ( ( a0 * b0 ) >> 32 ), n = a0 * b1 + ( m & 0xFFFF'FFFF );
+    hi_ = a1 * b1 + ( m >> 32 ) + ( n >> 32 );
+    return a_ * b_;
+#endif
+}
+
+// 64 x 64 -> 128 bit multiply, folded (lo ^ hi) to 64 bits.
+inline std::uint64_t mul_fold ( const std::uint64_t a_, const std::uint64_t b_ ) noexcept {
+    std::uint64_t hi;
+    const std::uint64_t lo = mul_wide ( a_, b_, hi );
+    return lo ^ hi;
+}
+
+namespace detail {
+
+constexpr std::uint64_t hash_values_k [ 10 ] = { 0xA0761D6478BD642F, 0xE7037ED1A0B428DB, 0x8EBC6AF09C88C6E3, 0x589965CC75374CC3, 0x9E3779B97F4A7C15,
+                                                 0xD6E8FEB86659FD93, 0xFF51AFD7ED558CCD, 0xC4CEB9FE1A85EC53, 0x0CF3FD1B9997F637, 0xAFC1530680179F87 };
+
+// Strings, string_views, vectors and arrays of trivially copyable elements.
+template<typename T, typename = void>
+struct is_contiguous_trivial : std::false_type { };
+template<typename T>
+struct is_contiguous_trivial<T, std::void_t<typename T::value_type, decltype ( std::declval<const T &> ( ).data ( ) ), decltype ( std::declval<const T &> ( ).size ( ) )>> :
+    std::conjunction<std::is_same<std::remove_cv_t<std::remove_pointer_t<decltype ( std::declval<const T &> ( ).data ( ) )>>, typename T::value_type>,
+                     std::is_trivially_copyable<typename T::value_type>> {
+};
+
+// The 64-bit word a value contributes to hash_values () and hash_range ().
+template<typename T>
+std::uint64_t hash_word ( const T & v_ ) noexcept {
+    if constexpr ( std::is_integral<T>::value ) {
+        return ( std::uint64_t ) v_;
+    }
+    else if constexpr ( std::is_enum<T>::value ) {
+        return ( std::uint64_t ) static_cast<std::underlying_type_t<T>> ( v_ );
+    }
+    else if constexpr ( std::is_pointer<T>::value ) {
+        return ( std::uint64_t ) reinterpret_cast<std::uintptr_t> ( v_ );
+    }
+    else if constexpr ( std::is_floating_point<T>::value && sizeof ( T ) <= 8 ) {
+        const T v = v_ == T ( 0 ) ? T ( 0 ) : v_; // -0.0 == 0.0.
+        std::uint64_t w = 0;
+        std::memcpy ( &w, &v, sizeof ( T ) );
+        return w;
+    }
+    else if constexpr ( is_contiguous_trivial<T>::value ) {
+        return hash_bytes ( v_.data ( ), v_.size ( ) * sizeof ( typename T::value_type ) );
+    }
+    else if constexpr ( std::has_unique_object_representations<T>::value ) {
+        if constexpr ( sizeof ( T ) <= 8 ) {
+            std::uint64_t w = 0;
+            std::memcpy ( &w, &v_, sizeof ( T ) );
+            return w;
+        }
+        else {
+            return hash_bytes ( &v_, sizeof ( T ) );
+        }
+    }
+    else {
+        return ( std::uint64_t ) std::hash<T> { } ( v_ );
+    }
+}
+
+// Mixes two words, mul_fold ( a, b ) is 0 for any b if a is 0, the xor
+// of a and b keeps a zero operand from wiping out the other one.
+inline std::uint64_t hash_mix ( const std::uint64_t a_, const std::uint64_t b_ ) noexcept {
+    return mul_fold ( a_, b_ ) ^ a_ ^ b_;
+}
+
+// 8 words in 4 independent lanes, one 128-bit multiply per 2 words.
+inline void hash_words_step ( std::uint64_t * s_, const std::uint64_t * w_ ) noexcept {
+    s_ [ 0 ] = hash_mix ( w_ [ 0 ] ^ hash_values_k [ 0 ] ^ s_ [ 0 ], w_ [ 1 ] ^ hash_values_k [ 1 ] );
+    s_ [ 1 ] = hash_mix ( w_ [ 2 ] ^ hash_values_k [ 2 ] ^ s_ [ 1 ], w_ [ 3 ] ^ hash_values_k [ 3 ] );
+    s_ [ 2 ] = hash_mix ( w_ [ 4 ] ^ hash_values_k [ 4 ] ^ s_ [ 2 ], w_ [ 5 ] ^ hash_values_k [ 5 ] );
+    s_ [ 3 ] = hash_mix ( w_ [ 6 ] ^ hash_values_k [ 6 ] ^ s_ [ 3 ], w_ [ 7 ] ^ hash_values_k [ 7 ] );
+}
+
+inline std::uint64_t hash_words_final ( const std::uint64_t * s_, const std::uint64_t len_ ) noexcept {
+    const std::uint64_t h = hash_mix ( s_ [ 0 ] ^ s_ [ 2 ] ^ hash_values_k [ 8 ], s_ [ 1 ] ^ s_ [ 3 ] ^ hash_values_k [ 9 ] );
+    return mul_fold ( h ^ len_, hash_values_k [ 4 ] );
+}
+
+// The last n_ ( < 8 ) words, only the lanes that have words are mixed,
+// followed by the finalization, len_ is the total length in bytes.
+inline std::uint64_t hash_words_tail ( std::uint64_t * s_, const std::uint64_t * w_, const std::size_t n_, const std::uint64_t len_ ) noexcept {
+    for ( std::size_t i = 0; i < n_; i += 2 ) {
+        s_ [ i / 2 ] = hash_mix ( w_ [ i ] ^ hash_values_k [ i ] ^ s_ [ i / 2 ], ( i + 1 < n_ ? w_ [ i + 1 ] : 0 ) ^ hash_values_k [ i + 1 ] );
+    }
+    return hash_words_final ( s_, len_ );
+}
+
+// Same, for a tail length known at compile time, in straight-line code.
+template<std::size_t N, std::size_t... L>
+std::uint64_t hash_words_tail ( std::uint64_t * s_, const std::uint64_t * w_, const std::uint64_t len_, std::index_sequence<L...> ) noexcept {
+    ( ( s_ [ L ] = hash_mix ( w_ [ 2 * L ] ^ hash_values_k [ 2 * L ] ^ s_ [ L ], ( 2 * L + 1 < N ? w_ [ 2 * L + 1 ] : 0 ) ^ hash_values_k [ 2 * L + 1 ] ) ), ... );
+    return hash_words_final ( s_, len_ );
+}
+
+// len_ bytes at p_, 64 bytes per step, p_ can be nullptr if len_ is 0.
+inline std::uint64_t hash_contiguous ( const unsigned char * p_, const std::size_t len_ ) noexcept {
+    std::uint64_t w [ 8 ], s [ 4 ] = { };
+    std::size_t n = len_;
+    for ( ; n >= 64; n -= 64, p_ += 64 ) {
+        std::memcpy ( w, p_, 64 );
+        hash_words_step ( s, w );
+    }
+    w [ n / 8 ] = 0;
+    if ( n ) { // memcpy ( ) from nullptr is undefined, even of 0 bytes.
+        std::memcpy ( w, p_, n );
+    }
+    return hash_words_tail ( s, w, ( n + 7 ) / 8, len_ );
+}
+
+// Pointers, and the iterators of vectors and strings (the ones that can
+// be told apart before C++20's contiguous_iterator).
+template<typename It, typename V = std::remove_cv_t<typename std::iterator_traits<It>::value_type>>
+struct is_contiguous_iterator :
+#if defined ( __cpp_lib_concepts )
+    std::bool_constant<std::contiguous_iterator<It>> {
+#else
+    std::disjunction<std::is_pointer<It>,
+                     std::conjunction<std::negation<std::is_same<V, bool>>, std::disjunction<std::is_same<It, typename std::vector<V>::iterator>, std::is_same<It, typename std::vector<V>::const_iterator>>>,
+                     std::conjunction<std::is_same<V, char>, std::disjunction<std::is_same<It, std::string::iterator>, std::is_same<It, std::string::const_iterator>, std::is_same<It, std::string_view::const_iterator>>>> {
+#endif
+};
+} // namespace detail
+
+// Hashes a composite key, hash_values ( a, b, c ) hashes the tuple ( a,
+// b, c ), without going through std::hash or a serial hash_combine ()
+// chain. Every value contributes a 64-bit word (integers, enums, pointers
+// and floats are taken as is, strings and larger objects, with a unique
+// object representation, through hash_bytes (), anything else through
+// std::hash). Pairs of words are mixed with a 128-bit multiply (folded,
+// and xored with both words, a word can't cancel its partner),
+// in 4 independent lanes, for up to 8 values the dependency chain is 3
+// multiplies long.
+template<typename... Ts>
+std::uint64_t hash_values ( const Ts &... v_ ) noexcept {
+    constexpr std::size_t n = sizeof... ( Ts ), m = n % 8;
+    const std::uint64_t w [ n + 1 ] = { detail::hash_word ( v_ )... };
+    std::uint64_t s [ 4 ] = { };
+    for ( std::size_t i = 0; i + 8 <= n; i += 8 ) {
+        detail::hash_words_step ( s, w + i );
+    }
+    return detail::hash_words_tail<m> ( s, w + n - m, 8 * n, std::make_index_sequence<( m + 1 ) / 2> { } );
+}
+
+// Hashes the elements of [ first_, last_ ), in the way of hash_values ().
+// Elements with a unique object representation are hashed as bytes, 64
+// bytes (2 x 32) per step, straight from memory for contiguous ranges
+// (pointers, vector and string iterators), packed by the same rule
+// otherwise, the hash only depends on the elements. For 8-byte elements
+// the result agrees with hash_values ().
+template<typename It>
+std::uint64_t hash_range ( It first_, const It last_ ) noexcept {
+    using T = std::remove_cv_t<typename std::iterator_traits<It>::value_type>;
+    std::uint64_t w [ 8 ], s [ 4 ] = { }, len = 0;
+    if constexpr ( std::has_unique_object_representations<T>::value ) {
+        if constexpr ( detail::is_contiguous_iterator<It>::value ) {
+            const std::size_t n = ( std::size_t ) std::distance ( first_, last_ );
+            return detail::hash_contiguous ( n ? reinterpret_cast<const unsigned char *> ( &*first_ ) : nullptr, n * sizeof ( T ) );
+        }
+        else {
+            unsigned char b [ 64 + sizeof ( T ) ];
+            std::size_t n = 0;
+            for ( ; first_ != last_; ++first_ ) {
+                const T v = *first_;
+                std::memcpy ( b + n, &v, sizeof ( T ) );
+                for ( n += sizeof ( T ); n >= 64; n -= 64, len += 64 ) {
+                    std::memcpy ( w, b, 64 );
+                    detail::hash_words_step ( s, w );
+                    std::memmove ( b, b + 64, n - 64 );
+                }
+            }
+            w [ n / 8 ] = 0;
+            std::memcpy ( w, b, n );
+            return detail::hash_words_tail ( s, w, ( n + 7 ) / 8, len + n );
+        }
+    }
+    else {
+        std::size_t n = 0;
+        for ( ; first_ != last_; ++first_ ) {
+            w [ n++ ] = detail::hash_word ( *first_ );
+            if ( n == 8 ) {
+                detail::hash_words_step ( s, w );
+                len += 64;
+                n = 0;
+            }
+        }
+        return detail::hash_words_tail ( s, w, n, len + 8 * n );
+    }
+}
+
 // An invertible function used to mix the bits, borrowed from murmurhash.
 constexpr std::uint64_t fmix64 ( std::uint64_t k ) noexcept {
     k ^= k >> 33;
@@ -260,6 +557,47 @@ constexpr std::uint64_t fmix64 ( std::uint64_t k ) noexcept {
     return k;
 }
 
+// Low 64 bits of the 4 lane products, AVX2 has no 64-bit multiply, it's
+// put together from three 32-bit ones.
+inline __m256i mullo_epi64 ( const __m256i a_, const __m256i b_ ) noexcept {
+    const __m256i lo = _mm256_mul_epu32 ( a_, b_ );
+    const __m256i hi = _mm256_add_epi64 ( _mm256_mul_epu32 ( _mm256_srli_epi64 ( a_, 32 ), b_ ), _mm256_mul_epu32 ( a_, _mm256_srli_epi64 ( b_, 32 ) ) );
+    return _mm256_add_epi64 ( lo, _mm256_slli_epi64 ( hi, 32 ) );
+}
+
+// fmix64 on 4 lanes.
+inline __m256i fmix64 ( __m256i k ) noexcept {
+    k = _mm256_xor_si256 ( k, _mm256_srli_epi64 ( k, 33 ) );
+    k = mullo_epi64 ( k, _mm256_set1_epi64x ( ( long long ) 0xFF51AFD7ED558CCD ) );
+    k = _mm256_xor_si256 ( k, _mm256_srli_epi64 ( k, 33 ) );
+    k = mullo_epi64 ( k, _mm256_set1_epi64x ( ( long long ) 0xC4CEB9FE1A85EC53 ) );
+    k = _mm256_xor_si256 ( k, _mm256_srli_epi64 ( k, 33 ) );
+    return k;
+}
+
+// Jump consistent hash (Lamping & Veach, arXiv:1406.2294), maps key_ to a
+// bucket in [ 0, buckets_ ), buckets_ > 0. Going from n to n + 1 buckets
+// moves only 1 / ( n + 1 ) of the keys (all to the new bucket), where
+// hash % n moves almost all of them. Expected O ( log buckets_ ) steps.
+// The key is mixed with fmix64 () first, so sequential keys spread as
+// well.
+constexpr std::uint32_t jump_hash ( std::uint64_t key_, const std::uint32_t buckets_ ) noexcept {
+    assert ( buckets_ > 0 );
+    key_ = fmix64 ( key_ );
+    std::int64_t b = -1, j = 0;
+    while ( j < buckets_ ) {
+        b    = j;
+        key_ = key_ * 2862933555777941757ULL + 1;
+        j    = ( std::int64_t ) ( ( b + 1 ) * ( double ( std::int64_t { 1 } << 31 ) / double ( ( key_ >> 33 ) + 1 ) ) );
+    }
+    return ( std::uint32_t ) b;
+}
+
+// jump_hash () of n_ keys, out_ [ i ] = jump_hash ( keys_ [ i ], buckets_ ),
+// buckets_ > 0. The loops of 8 keys run side by side in AVX2 lanes, until
+// the last lane is done.
+void jump_hash_batch ( const std::uint64_t * keys_, const std::size_t n_, const std::uint32_t buckets_, std::uint32_t * out_ ) noexcept;
+
 template<typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>, std::is_unsigned<T>>>>
 constexpr std::uint32_t popCount ( const T x_ ) noexcept {
     if constexpr ( std::is_same<T, std::uint64_t>::value ) {
@@ -270,6 +608,56 @@ constexpr std::uint32_t popCount ( const T x_ ) noexcept {
     }
 }
 
+// Trailing zero count, returns the width of T for 0.
+template<typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>, std::is_unsigned<T>>>>
+inline std::uint32_t tzCount ( const T x_ ) noexcept {
+    if ( !x_ ) {
+        return 8 * sizeof ( T );
+    }
+#ifdef _MSC_VER
+    unsigned long i;
+    if constexpr ( std::is_same<T, std::uint64_t>::value ) {
+        _BitScanForward64 ( &i, x_ );
+    }
+    else {
+        _BitScanForward ( &i, ( unsigned long ) x_ );
+    }
+    return ( std::uint32_t ) i;
+#else
+    if constexpr ( std::is_same<T, std::uint64_t>::value ) {
+        return ( std::uint32_t ) __builtin_ctzll ( x_ );
+    }
+    else {
+        return ( std::uint32_t ) __builtin_ctz ( ( std::uint32_t ) x_ );
+    }
+#endif
+}
+
+// Leading zero count, returns the width of T for 0.
+template<typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>, std::is_unsigned<T>>>>
+inline std::uint32_t lzCount ( const T x_ ) noexcept {
+    if ( !x_ ) {
+        return 8 * sizeof ( T );
+    }
+#ifdef _MSC_VER
+    unsigned long i;
+    if constexpr ( std::is_same<T, std::uint64_t>::value ) {
+        _BitScanReverse64 ( &i, x_ );
+    }
+    else {
+        _BitScanReverse ( &i, ( unsigned long ) x_ );
+    }
+    return ( std::uint32_t ) ( 8 * sizeof ( T ) - 1 - i );
+#else
+    if constexpr ( std::is_same<T, std::uint64_t>::value ) {
+        return ( std::uint32_t ) __builtin_clzll ( x_ );
+    }
+    else {
+        return ( std::uint32_t ) __builtin_clz ( ( std::uint32_t ) x_ ) - ( 32 - 8 * sizeof ( T ) );
+    }
+#endif
+}
+
 template < typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
 constexpr T make_odd ( const T i_ ) noexcept {
     return i_ | T ( 1 );
@@ -289,10 +677,41 @@ T bit_xor ( const T l_, const T r_ ) noexcept {
 
 // Seeding.
 
+// Fills s_ [ 0, n_ ) with seeds. The seeds come from a process wide pool,
+// which reads os entropy (getrandom ( ) or rand_s ( ), rdseed as a fall
+// back) in blocks and stretches every word of it to 16 seeds with a
+// splitmix64. Thread safe, a seed costs a few ns, seed many at once.
+void seed ( std::uint64_t * s_, const std::size_t n_ ) noexcept;
+
 void seed ( std::uint32_t & s_ ) noexcept;
 void seed ( std::uint64_t & s_ ) noexcept;
 std::uintmax_t seed ( ) noexcept;
 
+// A seed sequence on iu::seed ( ), for seeding the std (and meo) generators,
+// as in std::mt19937_64 rng ( entropy ), with entropy an iu::entropy_seq lvalue.
+struct entropy_seq {
+
+    using result_type = std::uint32_t;
+
+    template<typename It>
+    void generate ( It first_, const It last_ ) noexcept {
+        std::uint64_t s [ 16 ];
+        while ( first_ != last_ ) {
+            seed ( s, 16 );
+            for ( int i = 0; i < 32 && first_ != last_; ++i, ++first_ ) {
+                *first_ = ( result_type ) ( s [ i / 2 ] >> ( 32 * ( i & 1 ) ) );
+            }
+        }
+    }
+
+    static constexpr std::size_t size ( ) noexcept {
+        return 0;
+    }
+
+    template<typename It>
+    void param ( It ) const noexcept { }
+};
+
 
 // http://xoroshiro.di.unimi.it/
 
@@ -329,21 +748,37 @@ class xoroshiro {
 
     // Seed by default.
     xoroshiro ( ) noexcept {
-        auto _seed = [ ] ( ) { result_type s; iu::seed ( s ); return s; };
-        m_s0 = _seed ( );
-        m_s1 = _seed ( );
+        std::uint64_t s [ 2 ];
+        do {
+            iu::seed ( s, 2 );
+            m_s0 = ( StateType ) s [ 0 ];
+            m_s1 = ( StateType ) s [ 1 ];
+        } while ( !( m_s0 | m_s1 ) );
     }
 
     xoroshiro ( const std::uint64_t s_ ) noexcept {
         seed ( s_ );
     }
 
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    explicit xoroshiro ( Sseq & q_ ) {
+        seed ( q_ );
+    }
+
     void seed ( const std::uint64_t s_ ) noexcept {
         sax::splitmix64 rng ( s_ );
         m_s0 = rng ( );
         m_s1 = rng ( );
     }
 
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    void seed ( Sseq & q_ ) {
+        std::uint64_t s [ 2 ];
+        detail::seed_words ( q_, s, 2 );
+        m_s0 = ( StateType ) s [ 0 ];
+        m_s1 = ( StateType ) ( s [ 1 ] | !( StateType ) s [ 0 ] );
+    }
+
     bool operator == ( const xoroshiro & rhs ) noexcept {
         return ( m_s0 == rhs.m_s0 ) && ( m_s1 == rhs.m_s1 );
     }
@@ -353,45 +788,112 @@ class xoroshiro {
     }
 
     ResultType operator ( ) ( ) noexcept {
-        const StateType result = m_s0 + m_s1;
+        const ResultType result = output ( m_s0, m_s1 );
         next ( );
-        return result >> ( 8 * ( sizeof ( StateType ) - sizeof ( ResultType ) ) );
+        return result;
+    }
+
+    // Writes the next n_ values to out_, the state is kept in locals, so
+    // the stores to out_ don't force it back to memory.
+    void generate ( ResultType * out_, const std::size_t n_ ) noexcept {
+        StateType s0 = m_s0, s1 = m_s1;
+        std::size_t i = 0;
+        for ( ; i + 4 <= n_; i += 4 ) {
+            out_ [ i + 0 ] = output ( s0, s1 );
+            next ( s0, s1 );
+            out_ [ i + 1 ] = output ( s0, s1 );
+            next ( s0, s1 );
+            out_ [ i + 2 ] = output ( s0, s1 );
+            next ( s0, s1 );
+            out_ [ i + 3 ] = output ( s0, s1 );
+            next ( s0, s1 );
+        }
+        for ( ; i < n_; ++i ) {
+            out_ [ i ] = output ( s0, s1 );
+            next ( s0, s1 );
+        }
+        m_s0 = s0;
+        m_s1 = s1;
+    }
+
+    template<typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, ResultType>::value>>
+    void generate ( Container & c_ ) noexcept {
+        generate ( std::data ( c_ ), std::size ( c_ ) );
     }
 
     // This is the jump function for the generator. It is equivalent
     // to 2^64 calls to next(); it can be used to generate 2^64
     // non-overlapping subsequences for parallel computations.
+    // (2^(N/2) calls for N bits of state.)
     void jump ( ) noexcept {
-        static const std::uint64_t j0 = 0xbeac0467eba5facb, j1 = 0xd86b048b86aa9922;//???
-        std::uint64_t s0 = 0, s1 = 0;
-        for ( std::size_t b = 0; b < 64ULL; ++b ) {
-            if ( j0 & 1ULL << b ) {
-                s0 ^= m_s0;
-                s1 ^= m_s1;
-            }
-            m_s1 = m_s0 ^ m_s1;
-            m_s0 = rotl ( m_s0, a ) ^ m_s1 ^ ( m_s1 << a );
-            m_s1 = rotl ( m_s1, c );
-        }
-        for ( std::uint64_t b = 0; b < 64ULL; ++b ) {
-            if ( j1 & 1ULL << b ) {
+        static const poly j = char_poly ( ).pow2 ( state_bits / 2 );
+        jump ( j );
+    }
+
+    // Equivalent to 2^96 calls to next(); it can be used to generate
+    // 2^32 starting points, from each of which jump() will generate
+    // 2^32 non-overlapping subsequences for parallel distributed
+    // computations. (2^(3N/4) calls for N bits of state.)
+    void long_jump ( ) noexcept {
+        static const poly j = char_poly ( ).pow2 ( 3 * state_bits / 4 );
+        jump ( j );
+    }
+
+    // Equivalent to k_ calls to operator ( ), k_ = hi_ * 2^64 + lo_.
+    void discard ( const std::uint64_t hi_, const std::uint64_t lo_ ) noexcept {
+        jump ( char_poly ( ).pow ( hi_, lo_ ) );
+    }
+
+#ifdef __SIZEOF_INT128__
+    void discard ( const unsigned __int128 k_ ) noexcept {
+        discard ( ( std::uint64_t ) ( k_ >> 64 ), ( std::uint64_t ) k_ );
+    }
+#else
+    void discard ( const std::uint64_t k_ ) noexcept {
+        discard ( 0, k_ );
+    }
+#endif
+
+    private:
+
+    static constexpr std::size_t state_bits = 16 * sizeof ( StateType );
+
+    using poly = detail::gf2_poly<state_bits>;
+
+    static const detail::gf2_char_poly<state_bits> & char_poly ( ) noexcept {
+        static const detail::gf2_char_poly<state_bits> p ( [ s0 = StateType ( 0x9E3779B97F4A7C15 ), s1 = StateType ( 0xBF58476D1CE4E5B9 ) ] ( ) mutable {
+            const bool r = s0 & 1;
+            next ( s0, s1 );
+            return r;
+        } );
+        return p;
+    }
+
+    void jump ( const poly & j_ ) noexcept {
+        StateType s0 = 0, s1 = 0;
+        for ( std::size_t i = 0; i < state_bits; ++i ) {
+            if ( j_.coefficient ( i ) ) {
                 s0 ^= m_s0;
                 s1 ^= m_s1;
             }
-            m_s1 = m_s0 ^ m_s1;
-            m_s0 = rotl ( m_s0, a ) ^ m_s1 ^ ( m_s1 << b );
-            m_s1 = rotl ( m_s1, c );
+            next ( );
         }
         m_s0 = s0;
         m_s1 = s1;
     }
 
-    private:
+    static ResultType output ( const StateType s0_, const StateType s1_ ) noexcept {
+        return ( ResultType ) ( StateType ( s0_ + s1_ ) >> ( 8 * ( sizeof ( StateType ) - sizeof ( ResultType ) ) ) );
+    }
+
+    static void next ( StateType & s0_, StateType & s1_ ) noexcept {
+        s1_ ^= s0_;
+        s0_ = rotl ( s0_, a ) ^ s1_ ^ ( s1_ << b );
+        s1_ = rotl ( s1_, c );
+    }
 
     void next ( ) noexcept {
-        m_s1 ^= m_s0;
-        m_s0 = rotl ( m_s0, a ) ^ m_s1 ^ ( m_s1 << b );
-        m_s1 = rotl ( m_s1, c );
+        next ( m_s0, m_s1 );
     }
 
     StateType m_s0, m_s1;
@@ -419,11 +921,43 @@ struct xoroshiro4x128plusavx {
     xoroshiro4x128plusavx ( ) noexcept;
     xoroshiro4x128plusavx ( const std::uint64_t s_ ) noexcept;
 
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    explicit xoroshiro4x128plusavx ( Sseq & q_ ) {
+        seed ( q_ );
+    }
+
     void seed ( const std::uint64_t s_ ) noexcept;
+
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    void seed ( Sseq & q_ ) {
+        std::uint64_t s [ 8 ];
+        detail::seed_words ( q_, s, 8 );
+        seed ( s );
+    }
+
     result_type operator ( ) ( ) noexcept;
 
+    // Writes the next n_ values to out_, the same values as n_ calls to
+    // operator ( ), whole vectors are stored, 4 steps per iteration.
+    void generate ( result_type * out_, const std::size_t n_ ) noexcept;
+
+    template<typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, result_type>::value>>
+    void generate ( Container & c_ ) noexcept {
+        generate ( std::data ( c_ ), std::size ( c_ ) );
+    }
+
+    // The rotates cross the 64-bit lanes, the 4 lanes are one generator
+    // with 512 bits of state (not 4 xoroshiro128+'s). jump ( ) is
+    // equivalent to 2^256 steps (of 4 values), long_jump ( ) to 2^384
+    // steps, the values still buffered are dropped.
+    void jump ( ) noexcept;
+    void long_jump ( ) noexcept;
+
     private:
 
+    // Lane i of s0 and s1 from s_ [ i ] and s_ [ 4 + i ].
+    void seed ( const std::uint64_t * s_ ) noexcept;
+
     __declspec ( align ( 32 ) ) __m256i m_s0, m_s1, m_r;
 
     static constexpr std::size_t start_case ( ) {
@@ -435,6 +969,71 @@ struct xoroshiro4x128plusavx {
 
 // #endif
 
+// 8 independent xoroshiro128+ (24, 16, 37) generators in the lanes of a
+// __m512i, lane i is the stream of lane 0 jumped ahead i * 2^64 steps, so
+// the lanes don't overlap. The rotates are native (vprolq). The members
+// are defined in xoroshiro_avx512.cpp, which is the only TU compiled for
+// AVX-512, check is_supported ( ) before constructing one.
+
+struct xoroshiro8x128plusavx512 {
+
+    using result_type = std::uint64_t;
+
+    constexpr static result_type min ( ) {
+        return std::numeric_limits<result_type>::min ( );
+    }
+
+    constexpr static result_type max ( ) {
+        return std::numeric_limits<result_type>::max ( );
+    }
+
+    // True if the cpu (and the os) supports AVX-512F.
+    static bool is_supported ( ) noexcept;
+
+    //System seeded by default.
+    xoroshiro8x128plusavx512 ( ) noexcept;
+    xoroshiro8x128plusavx512 ( const std::uint64_t s_ ) noexcept;
+
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    explicit xoroshiro8x128plusavx512 ( Sseq & q_ ) {
+        seed ( q_ );
+    }
+
+    void seed ( const std::uint64_t s_ ) noexcept;
+
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    void seed ( Sseq & q_ ) {
+        std::uint64_t s [ 2 ];
+        detail::seed_words ( q_, s, 2 );
+        seed ( s [ 0 ], s [ 1 ] );
+    }
+
+    result_type operator ( ) ( ) noexcept;
+
+    // Writes the next n_ values to out_, the same values as n_ calls to
+    // operator ( ), whole vectors are stored, 4 steps per iteration.
+    void generate ( result_type * out_, const std::size_t n_ ) noexcept;
+
+    template<typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, result_type>::value>>
+    void generate ( Container & c_ ) noexcept {
+        generate ( std::data ( c_ ), std::size ( c_ ) );
+    }
+
+    // Jumps every lane ahead 8 * 2^64 steps, past the streams of the other
+    // lanes, copies jumped 0, 1, 2, ... times don't overlap. The values
+    // still buffered are dropped.
+    void jump ( ) noexcept;
+
+    private:
+
+    void seed ( std::uint64_t s0_, std::uint64_t s1_ ) noexcept;
+
+    __declspec ( align ( 64 ) ) __m512i m_s0, m_s1;
+    __declspec ( align ( 64 ) ) result_type m_r [ 8 ];
+
+    std::size_t m_i;
+};
+
 template<typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>, std::is_unsigned<T>>>>
 void print_bits ( const T n ) noexcept {
     T i = T ( 1 ) << ( sizeof ( T ) * 8 - 1 );
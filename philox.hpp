@@ -0,0 +1,235 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+namespace detail {
+
+// Multipliers and Weyl constants of Philox4x64.
+constexpr std::uint64_t philox_m0 = 0xD2E7470EE14C6C93, philox_m1 = 0xCA5A826395121157;
+constexpr std::uint64_t philox_w0 = 0x9E3779B97F4A7C15, philox_w1 = 0xBB67AE8584CAA73B;
+
+constexpr int philox_rounds = 10;
+
+#if defined ( __AVX512F__ )
+// The 64 x 64 -> 128 bit products of the lanes of a_ and m_, from 32-bit
+// products, returns the low halves, the high halves go to hi_.
+inline __m512i philox_mul_wide ( const __m512i a_, const std::uint64_t m_, __m512i & hi_ ) noexcept {
+    const __m512i lo32 = _mm512_set1_epi64 ( 0xFFFF'FFFF ), ml = _mm512_set1_epi64 ( ( long long ) ( m_ & 0xFFFF'FFFF ) ), mh = _mm512_set1_epi64 ( ( long long ) ( m_ >> 32 ) );
+    const __m512i ah = _mm512_srli_epi64 ( a_, 32 );
+    const __m512i ll = _mm512_mul_epu32 ( a_, ml ), lh = _mm512_mul_epu32 ( a_, mh ), hl = _mm512_mul_epu32 ( ah, ml ), hh = _mm512_mul_epu32 ( ah, mh );
+    // The middle column, at most 34 bits.
+    const __m512i mid = _mm512_add_epi64 ( _mm512_add_epi64 ( _mm512_srli_epi64 ( ll, 32 ), _mm512_and_si512 ( lh, lo32 ) ), _mm512_and_si512 ( hl, lo32 ) );
+    hi_ = _mm512_add_epi64 ( _mm512_add_epi64 ( hh, _mm512_srli_epi64 ( mid, 32 ) ), _mm512_add_epi64 ( _mm512_srli_epi64 ( lh, 32 ), _mm512_srli_epi64 ( hl, 32 ) ) );
+    return _mm512_or_si512 ( _mm512_and_si512 ( ll, lo32 ), _mm512_slli_epi64 ( mid, 32 ) );
+}
+
+// Philox4x64 of 8 counters, c_ [ w ] holds word w of the counters (lane i
+// is counter i), the result replaces them.
+inline void philox4x64_8 ( __m512i ( &c_ ) [ 4 ], std::uint64_t k0_, std::uint64_t k1_ ) noexcept {
+    for ( int r = 0; r < philox_rounds; ++r, k0_ += philox_w0, k1_ += philox_w1 ) {
+        __m512i hi0, hi1;
+        const __m512i lo0 = philox_mul_wide ( c_ [ 0 ], philox_m0, hi0 ), lo1 = philox_mul_wide ( c_ [ 2 ], philox_m1, hi1 );
+        c_ [ 0 ] = _mm512_ternarylogic_epi64 ( hi1, c_ [ 1 ], _mm512_set1_epi64 ( ( long long ) k0_ ), 0x96 ); // a ^ b ^ c
+        c_ [ 2 ] = _mm512_ternarylogic_epi64 ( hi0, c_ [ 3 ], _mm512_set1_epi64 ( ( long long ) k1_ ), 0x96 );
+        c_ [ 1 ] = lo1;
+        c_ [ 3 ] = lo0;
+    }
+}
+#endif
+} // namespace detail
+
+// Philox4x64-10, a counter-based generator: the 4 values for a 256-bit
+// counter are 10 rounds of multiplies (64 x 64 -> 128) and xors of the
+// counter under a 128-bit key, a bijection of the counter for every key.
+// John K. Salmon, Mark A. Moraes, Ron O. Dror, David E. Shaw, "Parallel
+// Random Numbers: As Easy as 1, 2, 3", SC 2011.
+//
+// gen ( key, counter ) is stateless, any value of any stream is computed
+// directly, no jumps, no shared state, e.g. keyed by ( entity, step ):
+//
+//     const auto r = iu::philox4x64::gen ( { entity, seed }, { step, 0, 0, 0 } );
+//
+// As an engine, word 0 of the counter is the position in the stream, the
+// key and counter words 1 to 3 select the stream, the values come out 4
+// per counter, in word order. fill ( ) evaluates 8 counters per step with
+// AVX-512.
+class philox4x64 {
+
+    public:
+
+    using result_type  = std::uint64_t;
+    using key_type     = std::array<std::uint64_t, 2>;
+    using counter_type = std::array<std::uint64_t, 4>;
+
+    static constexpr result_type min ( ) noexcept {
+        return std::numeric_limits<result_type>::min ( );
+    }
+
+    static constexpr result_type max ( ) noexcept {
+        return std::numeric_limits<result_type>::max ( );
+    }
+
+    static counter_type gen ( key_type key_, counter_type c_ ) noexcept {
+        for ( int r = 0; r < detail::philox_rounds; ++r, key_ [ 0 ] += detail::philox_w0, key_ [ 1 ] += detail::philox_w1 ) {
+            std::uint64_t hi0, hi1;
+            const std::uint64_t lo0 = mul_wide ( c_ [ 0 ], detail::philox_m0, hi0 ), lo1 = mul_wide ( c_ [ 2 ], detail::philox_m1, hi1 );
+            c_ = { hi1 ^ c_ [ 1 ] ^ key_ [ 0 ], lo1, hi0 ^ c_ [ 3 ] ^ key_ [ 1 ], lo0 };
+        }
+        return c_;
+    }
+
+    explicit philox4x64 ( const std::uint64_t k0_ = 0, const std::uint64_t k1_ = 0 ) noexcept : m_key { { k0_, k1_ } } { }
+
+    explicit philox4x64 ( const key_type & key_, const counter_type & counter_ = { } ) noexcept : m_key { key_ }, m_counter { counter_ } { }
+
+    void seed ( const std::uint64_t k0_, const std::uint64_t k1_ = 0 ) noexcept {
+        m_key     = { { k0_, k1_ } };
+        m_counter = { };
+        m_i       = 4;
+    }
+
+    const key_type & key ( ) const noexcept {
+        return m_key;
+    }
+
+    // The counter of the next 4 values (when none are buffered).
+    const counter_type & counter ( ) const noexcept {
+        return m_counter;
+    }
+
+    void set_counter ( const counter_type & counter_ ) noexcept {
+        m_counter = counter_;
+        m_i       = 4;
+    }
+
+    result_type operator ( ) ( ) noexcept {
+        if ( m_i == 4 ) {
+            m_r = gen ( m_key, m_counter );
+            ++m_counter [ 0 ];
+            m_i = 0;
+        }
+        return m_r [ m_i++ ];
+    }
+
+    // Writes the next n_ values to out_, the same values as n_ calls to
+    // operator ( ).
+    void generate ( result_type * out_, std::size_t n_ ) noexcept {
+        for ( ; m_i < 4 && n_; --n_ ) {
+            *out_++ = m_r [ m_i++ ];
+        }
+        if ( !n_ ) {
+            return;
+        }
+        fill ( m_counter [ 0 ], out_, n_ / 4 * 4 );
+        m_counter [ 0 ] += n_ / 4;
+        if ( n_ % 4 ) {
+            m_r = gen ( m_key, m_counter );
+            ++m_counter [ 0 ];
+            std::memcpy ( out_ + n_ / 4 * 4, m_r.data ( ), ( n_ % 4 ) * sizeof ( result_type ) );
+            m_i = n_ % 4;
+        }
+    }
+
+    template<typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, result_type>::value>>
+    void generate ( Container & c_ ) noexcept {
+        generate ( std::data ( c_ ), std::size ( c_ ) );
+    }
+
+    // Writes the values of the counters counter_start_, counter_start_ + 1,
+    // ... (word 0, the other words those of counter ( )) to out_, random
+    // access, the engine doesn't advance.
+    void fill ( const std::uint64_t counter_start_, result_type * out_, const std::size_t n_ ) const noexcept {
+        std::uint64_t c = counter_start_;
+        std::size_t i   = 0;
+#if defined ( __AVX512F__ )
+        const __m512i step = _mm512_set1_epi64 ( 8 );
+        __m512i c0 = _mm512_add_epi64 ( _mm512_set1_epi64 ( ( long long ) c ), _mm512_setr_epi64 ( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+        for ( ; i + 32 <= n_; i += 32, c += 8, c0 = _mm512_add_epi64 ( c0, step ) ) {
+            __m512i w [ 4 ] = { c0, _mm512_set1_epi64 ( ( long long ) m_counter [ 1 ] ), _mm512_set1_epi64 ( ( long long ) m_counter [ 2 ] ),
+                                _mm512_set1_epi64 ( ( long long ) m_counter [ 3 ] ) };
+            detail::philox4x64_8 ( w, m_key [ 0 ], m_key [ 1 ] );
+            // Transpose, from word major to counter major.
+            const __m512i a = _mm512_unpacklo_epi64 ( w [ 0 ], w [ 1 ] ), b = _mm512_unpackhi_epi64 ( w [ 0 ], w [ 1 ] );
+            const __m512i d = _mm512_unpacklo_epi64 ( w [ 2 ], w [ 3 ] ), e = _mm512_unpackhi_epi64 ( w [ 2 ], w [ 3 ] );
+            const __m512i x0 = _mm512_shuffle_i64x2 ( a, d, _MM_SHUFFLE ( 1, 0, 1, 0 ) ), y0 = _mm512_shuffle_i64x2 ( b, e, _MM_SHUFFLE ( 1, 0, 1, 0 ) );
+            const __m512i x1 = _mm512_shuffle_i64x2 ( a, d, _MM_SHUFFLE ( 3, 2, 3, 2 ) ), y1 = _mm512_shuffle_i64x2 ( b, e, _MM_SHUFFLE ( 3, 2, 3, 2 ) );
+            _mm512_storeu_si512 ( out_ + i + 0, _mm512_shuffle_i64x2 ( x0, y0, _MM_SHUFFLE ( 2, 0, 2, 0 ) ) );
+            _mm512_storeu_si512 ( out_ + i + 8, _mm512_shuffle_i64x2 ( x0, y0, _MM_SHUFFLE ( 3, 1, 3, 1 ) ) );
+            _mm512_storeu_si512 ( out_ + i + 16, _mm512_shuffle_i64x2 ( x1, y1, _MM_SHUFFLE ( 2, 0, 2, 0 ) ) );
+            _mm512_storeu_si512 ( out_ + i + 24, _mm512_shuffle_i64x2 ( x1, y1, _MM_SHUFFLE ( 3, 1, 3, 1 ) ) );
+        }
+#endif
+        for ( ; i < n_; i += 4, ++c ) {
+            const counter_type r = gen ( m_key, { c, m_counter [ 1 ], m_counter [ 2 ], m_counter [ 3 ] } );
+            std::memcpy ( out_ + i, r.data ( ), ( n_ - i < 4 ? n_ - i : 4 ) * sizeof ( result_type ) );
+        }
+    }
+
+    template<typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, result_type>::value>>
+    void fill ( const std::uint64_t counter_start_, Container & c_ ) const noexcept {
+        fill ( counter_start_, std::data ( c_ ), std::size ( c_ ) );
+    }
+
+    // Equivalent to n_ calls to operator ( ).
+    void discard ( std::uint64_t n_ ) noexcept {
+        for ( ; m_i < 4 && n_; --n_ ) {
+            ++m_i;
+        }
+        m_counter [ 0 ] += n_ / 4;
+        if ( n_ % 4 ) {
+            m_r = gen ( m_key, m_counter );
+            ++m_counter [ 0 ];
+            m_i = ( unsigned ) ( n_ % 4 );
+        }
+    }
+
+    bool operator == ( const philox4x64 & rhs_ ) const noexcept {
+        return m_key == rhs_.m_key && m_counter == rhs_.m_counter && m_i == rhs_.m_i;
+    }
+
+    bool operator != ( const philox4x64 & rhs_ ) const noexcept {
+        return !operator== ( rhs_ );
+    }
+
+    private:
+
+    key_type m_key;
+    counter_type m_counter = { }, m_r = { };
+    unsigned m_i = 4;
+};
+} // namespace iu
@@ -21,43 +21,448 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+
 #ifdef _WIN32 // needed to allow binary stdout on windows
 #include <fcntl.h>
 #include <io.h>
+#else
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // vmsplice
+#endif
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
 #endif
 
 #include <cstdint>
-#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #ifndef __AVX2__
 #define __AVX2__ 1
 #endif
 
 #include "../integer_utils.hpp"
-#include "../splitmix.hpp"
+#include "../philox.hpp"
+#include "../random.hpp"
+#include "../rng_smoketest.hpp"
+#include "../simd_xoroshiro.hpp"
+#include "../stream_pool.hpp"
 #include "../xoroshiro_meo.hpp"
 
-// using Generator = splitmix64;
-// using Generator = meo::xoroshiro128plus64;
-using Generator = iu::xoroshiro4x128plusavx;
+// Feeds a generator to PractRand, as in
+//
+//     practrand meo::xoroshiro128plus32 | RNG_test stdin32
+//
+// practrand [ generator ] [ -q ] [ -r ] [ -l bits ] [ -t threads ] [ -s seed ] [ -n bytes ]
+//
+//   generator   by name (the namespace can be left out, or avx2, avx512,
+//               philox), practrand -h lists them, the default is
+//               iu::xoroshiro8x128plusavx512 if the cpu supports
+//               AVX-512, iu::xoroshiro4x128plusavx otherwise.
+//   -q          no output, run iu::rng_smoketest on the first -n bytes
+//               (256 MB by default) instead, the exit status is 1 on a
+//               failure.
+//   -r          reverse the bits of every value (of the low bits with -l).
+//   -l bits     only the low 8, 16 or 32 bits of every value.
+//   -t threads  producer threads, the default is all cores but one.
+//   -s seed     64-bit seed.
+//   -n bytes    stop after exactly that many bytes, the default is never.
+//
+// 128-bit values are output as two 64-bit values, low first. The stream
+// is the one of a single generator, in order. The producer threads fill
+// the chunks of a ring of buffers round robin, each thread skips the
+// chunks of the others with discard ( ), generators without discard ( )
+// get one producer thread. A writer thread writes the chunks in order to
+// stdout, on Linux, if stdout is a pipe, with vmsplice ( ) (no copy into
+// the pipe). The throughput goes to stderr.
+
+namespace {
 
-auto main ( ) -> int {
+// Small enough for the ring to stay in L2, larger than the pipe.
+constexpr std::size_t chunk_bytes = std::size_t { 1 } << 19;
 
-#ifdef _WIN32 // Needed to allow binary stdout on Windhoze...
-    _setmode ( _fileno ( stdout ), _O_BINARY );
-#endif
+struct options {
+    bool quick = false, reverse = false;
+    int low_bits       = 0;
+    unsigned threads   = 0;
+    std::uint64_t seed = 0xBEAC0467EBA5FACB, limit = 0;
+};
 
-    using result_type = typename Generator::result_type;
+template<typename Gen>
+constexpr bool can_skip = iu::detail::has_discard<Gen>::value || iu::detail::has_discard_n<Gen>::value;
 
-    Generator rng ( 0xBEAC0467EBA5FACB );
+template<typename Gen>
+void skip ( Gen & gen_, const std::uint64_t n_ ) noexcept {
+    if constexpr ( iu::detail::has_discard<Gen>::value ) {
+        gen_.discard ( 0, n_ );
+    }
+    else {
+        gen_.discard ( n_ );
+    }
+}
+
+inline std::uint64_t reverse_bits ( std::uint64_t x_ ) noexcept {
+    x_ = ( ( x_ >> 1 ) & 0x5555'5555'5555'5555 ) | ( ( x_ & 0x5555'5555'5555'5555 ) << 1 );
+    x_ = ( ( x_ >> 2 ) & 0x3333'3333'3333'3333 ) | ( ( x_ & 0x3333'3333'3333'3333 ) << 2 );
+    x_ = ( ( x_ >> 4 ) & 0x0F0F'0F0F'0F0F'0F0F ) | ( ( x_ & 0x0F0F'0F0F'0F0F'0F0F ) << 4 );
+    x_ = ( ( x_ >> 8 ) & 0x00FF'00FF'00FF'00FF ) | ( ( x_ & 0x00FF'00FF'00FF'00FF ) << 8 );
+    x_ = ( ( x_ >> 16 ) & 0x0000'FFFF'0000'FFFF ) | ( ( x_ & 0x0000'FFFF'0000'FFFF ) << 16 );
+    return ( x_ >> 32 ) | ( x_ << 32 );
+}
+
+// The low Bytes bytes of the words of in_, bit-reversed if reverse_, to out_.
+template<int Bytes, typename Word>
+void fold ( const Word * in_, const std::size_t n_, std::uint8_t * out_, const bool reverse_ ) noexcept {
+    for ( std::size_t i = 0; i < n_; ++i, out_ += Bytes ) {
+        std::uint64_t x = in_ [ i ];
+        if ( reverse_ ) {
+            x = reverse_bits ( x ) >> ( 64 - 8 * Bytes );
+        }
+        std::memcpy ( out_, &x, Bytes );
+    }
+}
+
+template<typename Word>
+void fold ( const Word * in_, const std::size_t n_, std::uint8_t * out_, const int bytes_, const bool reverse_ ) noexcept {
+    switch ( bytes_ ) {
+        case 1: fold<1> ( in_, n_, out_, reverse_ ); break;
+        case 2: fold<2> ( in_, n_, out_, reverse_ ); break;
+        case 4: fold<4> ( in_, n_, out_, reverse_ ); break;
+        default: fold<8> ( in_, n_, out_, reverse_ ); break;
+    }
+}
 
-    const std::size_t page_size = 524'288, buffer_size = page_size / sizeof ( result_type );
-    result_type buffer [ buffer_size ];
+// Chunk c goes in slot c % slots. A slot is free again once the writer is
+// done with its chunk, with vmsplice ( ) that is when the next chunk is in
+// the pipe (the pipe holds less than a chunk).
+class ring {
 
+    public:
+
+    ring ( const std::size_t slots_ ) : m_slots { slots_ }, m_data { new __m256i [ slots_ * chunk_bytes / sizeof ( __m256i ) ] }, m_ready ( slots_ ) { }
+
+    std::uint8_t * slot ( const std::uint64_t c_ ) noexcept {
+        return reinterpret_cast<std::uint8_t *> ( m_data.get ( ) ) + ( c_ % m_slots ) * chunk_bytes;
+    }
+
+    // Producer side.
+    std::uint8_t * acquire ( const std::uint64_t c_ ) {
+        std::unique_lock<std::mutex> lock ( m_mutex );
+        m_cv.wait ( lock, [ & ] { return c_ < m_freed + m_slots; } );
+        return slot ( c_ );
+    }
+    void publish ( const std::uint64_t c_ ) {
+        {
+            std::lock_guard<std::mutex> lock ( m_mutex );
+            m_ready [ c_ % m_slots ] = c_ + 1;
+        }
+        m_cv.notify_all ( );
+    }
+
+    // Writer side.
+    std::uint8_t * next ( const std::uint64_t c_ ) {
+        std::unique_lock<std::mutex> lock ( m_mutex );
+        m_cv.wait ( lock, [ & ] { return m_ready [ c_ % m_slots ] == c_ + 1; } );
+        return slot ( c_ );
+    }
+    // Chunks [ 0, n_ ) are done with.
+    void free ( const std::uint64_t n_ ) {
+        {
+            std::lock_guard<std::mutex> lock ( m_mutex );
+            m_freed = n_;
+        }
+        m_cv.notify_all ( );
+    }
+
+    private:
+
+    std::size_t m_slots;
+    std::unique_ptr<__m256i [ ]> m_data;
+    std::vector<std::uint64_t> m_ready;
+    std::uint64_t m_freed = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+std::atomic<std::uint64_t> bytes_written { 0 };
+
+// Bytes of the next chunk to write, all of it, or what's left to limit_.
+std::size_t bytes_to_write ( const std::uint64_t limit_ ) noexcept {
+    const std::uint64_t b = bytes_written;
+    return limit_ && limit_ - b < chunk_bytes ? ( std::size_t ) ( limit_ - b ) : chunk_bytes;
+}
+
+void write_out ( ring & ring_, const std::uint64_t limit_ ) {
+#ifdef _WIN32
+    for ( std::uint64_t c = 0;; ++c ) {
+        const std::uint8_t * p = ring_.next ( c );
+        const std::size_t m    = bytes_to_write ( limit_ );
+        for ( std::size_t n = 0; n < m; ) {
+            const int w = _write ( 1, p + n, ( unsigned ) ( m - n ) );
+            if ( w <= 0 ) {
+                // The reader is gone, PractRand is done.
+                std::_Exit ( EXIT_SUCCESS );
+            }
+            n += ( std::size_t ) w;
+        }
+        bytes_written += m;
+        if ( limit_ && bytes_written >= limit_ ) {
+            std::_Exit ( EXIT_SUCCESS );
+        }
+        ring_.free ( c + 1 );
+    }
+#else
+    struct stat s;
+    bool splice = !fstat ( 1, &s ) && S_ISFIFO ( s.st_mode );
+#ifdef __linux__
+    if ( splice ) {
+        fcntl ( 1, F_SETPIPE_SZ, 1 << 18 );
+        const int size = fcntl ( 1, F_GETPIPE_SZ );
+        splice         = size > 0 && ( std::size_t ) size < chunk_bytes;
+    }
+#else
+    splice = false;
+#endif
+    for ( std::uint64_t c = 0;; ++c ) {
+        const std::uint8_t * p = ring_.next ( c );
+        const std::size_t m    = bytes_to_write ( limit_ );
+        // Some of chunk c went to the pipe by reference.
+        bool spliced = false;
+        for ( std::size_t n = 0; n < m; ) {
+            ssize_t w;
+#ifdef __linux__
+            if ( splice ) {
+                iovec v { const_cast<std::uint8_t *> ( p + n ), m - n };
+                w = vmsplice ( 1, &v, 1, 0 );
+                if ( w < 0 && ( errno == EINVAL || errno == ENOSYS ) ) {
+                    // Not splicable after all, write ( ) the rest.
+                    splice = false;
+                    continue;
+                }
+                spliced = spliced || w > 0;
+            }
+            else
+#endif
+            {
+                w = write ( 1, p + n, m - n );
+            }
+            if ( w < 0 && errno == EINTR ) {
+                continue;
+            }
+            if ( w <= 0 ) {
+                // The reader is gone, PractRand is done.
+                std::_Exit ( errno == EPIPE ? EXIT_SUCCESS : EXIT_FAILURE );
+            }
+            n += ( std::size_t ) w;
+        }
+        bytes_written += m;
+        if ( limit_ && bytes_written >= limit_ ) {
+            std::_Exit ( EXIT_SUCCESS );
+        }
+        // Spliced pages are in use until the reader has them, that is once
+        // the next chunk is in the pipe. Chunk c - 1 is out of the pipe
+        // either way (a whole chunk went in after it).
+        ring_.free ( spliced ? c : c + 1 );
+    }
+#endif
+}
+
+template<typename Gen>
+void produce ( ring & ring_, const options & o_, const unsigned thread_, const unsigned threads_ ) {
+    using result_type     = typename Gen::result_type;
+    using word            = std::conditional_t<( sizeof ( result_type ) > 8 ), std::uint64_t, result_type>;
+    constexpr int words   = ( int ) ( sizeof ( result_type ) / sizeof ( word ) );
+    const int bytes       = o_.low_bits ? o_.low_bits / 8 : ( int ) sizeof ( word );
+    const bool folded     = o_.reverse || bytes < ( int ) sizeof ( word );
+    const std::size_t n   = chunk_bytes / bytes / words; // Values per chunk.
+    Gen gen               = iu::detail::make_generator<Gen> ( o_.seed );
+    std::vector<result_type> buffer ( folded ? n : 0 );
+    if constexpr ( can_skip<Gen> ) {
+        skip ( gen, thread_ * n );
+    }
+    for ( std::uint64_t c = thread_;; c += threads_ ) {
+        std::uint8_t * p = ring_.acquire ( c );
+        if ( folded ) {
+            iu::detail::generate ( gen, buffer.data ( ), n );
+            fold ( reinterpret_cast<const word *> ( buffer.data ( ) ), n * words, p, bytes, o_.reverse );
+        }
+        else {
+            iu::detail::generate ( gen, reinterpret_cast<result_type *> ( p ), n );
+        }
+        ring_.publish ( c );
+        if constexpr ( can_skip<Gen> ) {
+            if ( threads_ > 1 ) {
+                skip ( gen, ( threads_ - 1 ) * n );
+            }
+        }
+    }
+}
+
+template<typename Gen>
+void run ( const options & o_ ) {
+    if constexpr ( std::is_same<Gen, iu::xoroshiro8x128plusavx512>::value ) {
+        if ( !iu::xoroshiro8x128plusavx512::is_supported ( ) ) {
+            std::fprintf ( stderr, "AVX-512 is not supported on this cpu\n" );
+            std::exit ( EXIT_FAILURE );
+        }
+    }
+    if ( o_.low_bits && ( std::size_t ) o_.low_bits > 8 * std::min<std::size_t> ( sizeof ( typename Gen::result_type ), 8 ) ) {
+        std::fprintf ( stderr, "-l %d is more than the bits of a value\n", o_.low_bits );
+        std::exit ( EXIT_FAILURE );
+    }
+    if ( o_.quick ) {
+        const std::vector<iu::smoketest_result> results = iu::rng_smoketest ( o_.limit ? o_.limit : std::size_t { 1 } << 28, o_.threads ).run ( iu::detail::make_generator<Gen> ( o_.seed ) );
+        for ( const iu::smoketest_result & r : results ) {
+            std::printf ( "%-22s %14.3f  p = %-10.3g %s\n", r.name, r.statistic, r.p_value, iu::rng_smoketest::passed ( r ) ? "" : "FAIL" );
+        }
+        std::exit ( iu::rng_smoketest::passed ( results ) ? EXIT_SUCCESS : EXIT_FAILURE );
+    }
+    unsigned threads = o_.threads ? o_.threads : std::max ( std::thread::hardware_concurrency ( ), 2u ) - 1;
+    if ( !can_skip<Gen> ) {
+        threads = 1;
+    }
+    ring r ( 2 * threads + 2 );
+    std::vector<std::thread> pool;
+    for ( unsigned t = 0; t < threads; ++t ) {
+        pool.emplace_back ( produce<Gen>, std::ref ( r ), std::cref ( o_ ), t, threads );
+    }
+    std::thread writer ( write_out, std::ref ( r ), o_.limit );
+    // Report, every 10 seconds.
+    const auto start = std::chrono::steady_clock::now ( );
+    std::uint64_t last_bytes = 0;
+    auto last                = start;
     while ( true ) {
-        for ( std::size_t i = 0; i < buffer_size; ++i ) {
-            buffer [ i ] = rng ( );
+        std::this_thread::sleep_for ( std::chrono::seconds ( 10 ) );
+        const auto now          = std::chrono::steady_clock::now ( );
+        const std::uint64_t b   = bytes_written;
+        const double total      = std::chrono::duration<double> ( now - start ).count ( );
+        const double interval   = std::chrono::duration<double> ( now - last ).count ( );
+        std::fprintf ( stderr, "%.1f GB, %.0f MB/s, %.0f MB/s on average\n", b / 1e9, ( b - last_bytes ) / interval / 1e6, b / total / 1e6 );
+        last_bytes = b;
+        last       = now;
+    }
+}
+
+using runner = void ( * ) ( const options & );
+
+struct generator {
+    const char * name;
+    runner run;
+};
+
+const generator generators [ ] = {
+    { "iu::xoroshiro128plus64", run<iu::xoroshiro128plus64> },
+    { "iu::xoroshiro4x128plusavx", run<iu::xoroshiro4x128plusavx> },
+    { "iu::xoroshiro8x128plusavx512", run<iu::xoroshiro8x128plusavx512> },
+    { "iu::philox4x64", run<iu::philox4x64> },
+    { "iu::simd_xoroshiro128plus64", run<iu::simd_xoroshiro<meo::xoroshiro128plus64>> },
+    { "iu::simd_xoroshiro128starstar64", run<iu::simd_xoroshiro<meo::xoroshiro128starstar64>> },
+    { "iu::simd_xoroshiro128plus32", run<iu::simd_xoroshiro<meo::xoroshiro128plus32>> },
+    { "iu::simd_xoroshiro64star32", run<iu::simd_xoroshiro<meo::xoroshiro64star32>> },
+    { "iu::simd_xoroshiro64starstar32", run<iu::simd_xoroshiro<meo::xoroshiro64starstar32>> },
+    { "iu::simd_xoroshiro32plus16", run<iu::simd_xoroshiro<meo::xoroshiro32plus16>> },
+    { "sax::splitmix64", run<sax::splitmix64> },
+    { "meo::xoroshiro128plus64v0_1", run<meo::xoroshiro128plus64v0_1> },
+    { "meo::xoroshiro128plus64", run<meo::xoroshiro128plus64> },
+    { "meo::xoroshiro128starstar64", run<meo::xoroshiro128starstar64> },
+    { "meo::xoroshiro128plus32v0_1", run<meo::xoroshiro128plus32v0_1> },
+    { "meo::xoroshiro128plus32", run<meo::xoroshiro128plus32> },
+#ifdef __SIZEOF_INT128__
+    { "meo::xoroshiro256plus128", run<meo::xoroshiro256plus128> },
+    { "meo::xoroshiro256plus64", run<meo::xoroshiro256plus64> },
+#endif
+    { "meo::xoroshiro64plus32vMEO1", run<meo::xoroshiro64plus32vMEO1> },
+    { "meo::xoroshiro64plus32", run<meo::xoroshiro64plus32> },
+    { "meo::xoroshiro64star32", run<meo::xoroshiro64star32> },
+    { "meo::xoroshiro64starstar32", run<meo::xoroshiro64starstar32> },
+    { "meo::xoroshiro64plus16vMEO1", run<meo::xoroshiro64plus16vMEO1> },
+    { "meo::xoroshiro64plus16", run<meo::xoroshiro64plus16> },
+    { "meo::xoroshiro32plus16", run<meo::xoroshiro32plus16> },
+    { "meo::xoroshiro32star16", run<meo::xoroshiro32star16> },
+    { "meo::xoroshiro32plus8", run<meo::xoroshiro32plus8> },
+    { "meo::xoroshiro16plus8", run<meo::xoroshiro16plus8> },
+    { "meo::xoroshiro16star8", run<meo::xoroshiro16star8> },
+};
+
+[[noreturn]] void usage ( const int status_ ) {
+    std::fprintf ( stderr, "practrand [ generator ] [ -q ] [ -r ] [ -l 8|16|32 ] [ -t threads ] [ -s seed ] [ -n bytes ] | RNG_test stdin\n\ngenerators:\n" );
+    for ( const generator & g : generators ) {
+        std::fprintf ( stderr, "  %s\n", g.name );
+    }
+    std::exit ( status_ );
+}
+} // namespace
+
+auto main ( int argc, char ** argv ) -> int {
+
+#ifdef _WIN32 // Needed to allow binary stdout on Windhoze...
+    _setmode ( _fileno ( stdout ), _O_BINARY );
+#else
+    signal ( SIGPIPE, SIG_IGN );
+#endif
+
+    options o;
+    runner r = iu::xoroshiro8x128plusavx512::is_supported ( ) ? run<iu::xoroshiro8x128plusavx512> : run<iu::xoroshiro4x128plusavx>;
+
+    for ( int i = 1; i < argc; ++i ) {
+        const std::string a = argv [ i ];
+        const bool has_value = i + 1 < argc;
+        if ( a == "-h" || a == "--help" ) {
+            usage ( EXIT_SUCCESS );
+        }
+        else if ( a == "-q" ) {
+            o.quick = true;
+        }
+        else if ( a == "-r" ) {
+            o.reverse = true;
+        }
+        else if ( a == "-l" && has_value ) {
+            o.low_bits = std::atoi ( argv [ ++i ] );
+            if ( o.low_bits != 8 && o.low_bits != 16 && o.low_bits != 32 ) {
+                usage ( EXIT_FAILURE );
+            }
+        }
+        else if ( a == "-t" && has_value ) {
+            o.threads = ( unsigned ) std::strtoul ( argv [ ++i ], nullptr, 10 );
+        }
+        else if ( a == "-s" && has_value ) {
+            o.seed = std::strtoull ( argv [ ++i ], nullptr, 0 );
+        }
+        else if ( a == "-n" && has_value ) {
+            o.limit = std::strtoull ( argv [ ++i ], nullptr, 0 );
+        }
+        else if ( a == "avx2" || a == "avx512" || a == "philox" ) {
+            r = a == "avx2" ? run<iu::xoroshiro4x128plusavx> : a == "avx512" ? run<iu::xoroshiro8x128plusavx512> : run<iu::philox4x64>;
+        }
+        else {
+            const generator * g = std::find_if ( std::begin ( generators ), std::end ( generators ), [ & ] ( const generator & g_ ) {
+                return a == g_.name || a == std::strchr ( g_.name, ':' ) + 2;
+            } );
+            if ( g == std::end ( generators ) ) {
+                std::fprintf ( stderr, "unknown generator or option: %s\n", a.c_str ( ) );
+                usage ( EXIT_FAILURE );
+            }
+            r = g->run;
         }
-        std::cout.write ( reinterpret_cast<char*>( buffer ), page_size );
     }
+
+    r ( o );
+
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,497 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <immintrin.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+namespace detail {
+
+template<typename Gen, typename = void>
+struct has_generate : std::false_type { };
+template<typename Gen>
+struct has_generate<Gen, std::void_t<decltype ( std::declval<Gen &> ( ).generate ( std::declval<typename Gen::result_type *> ( ), std::size_t { } ) )>> : std::true_type { };
+
+// Bulk generation, through generate ( ) if Gen has it.
+template<typename Gen>
+void generate ( Gen & gen_, typename Gen::result_type * out_, const std::size_t n_ ) noexcept {
+    if constexpr ( has_generate<Gen>::value ) {
+        gen_.generate ( out_, n_ );
+    }
+    else {
+        for ( std::size_t i = 0; i < n_; ++i ) {
+            out_ [ i ] = gen_ ( );
+        }
+    }
+}
+
+template<typename Gen>
+constexpr bool is_full_range_generator ( ) noexcept {
+    using result_type = typename Gen::result_type;
+    return ( std::is_same<result_type, std::uint32_t>::value || std::is_same<result_type, std::uint64_t>::value ) && Gen::min ( ) == 0 && Gen::max ( ) == std::numeric_limits<result_type>::max ( );
+}
+
+// The high bits of a draw, 32-bit generators are called twice for 64 bits.
+template<typename Gen>
+std::uint32_t draw32 ( Gen & gen_ ) noexcept {
+    return ( std::uint32_t ) ( gen_ ( ) >> ( 8 * sizeof ( typename Gen::result_type ) - 32 ) );
+}
+
+template<typename Gen>
+std::uint64_t draw64 ( Gen & gen_ ) noexcept {
+    if constexpr ( sizeof ( typename Gen::result_type ) == 8 ) {
+        return gen_ ( );
+    }
+    else {
+        const std::uint64_t hi = gen_ ( );
+        return ( hi << 32 ) | gen_ ( );
+    }
+}
+
+// Lemire's multiply-shift, x_ * n_ / 2^32, x_ * n_ mod 2^32 < t_ = 2^32 mod n_ is rejected.
+template<typename Gen>
+std::uint32_t bounded32 ( Gen & gen_, const std::uint32_t n_, const std::uint32_t t_, std::uint64_t m_ ) noexcept {
+    while ( ( std::uint32_t ) m_ < t_ ) {
+        m_ = ( std::uint64_t ) draw32 ( gen_ ) * n_;
+    }
+    return ( std::uint32_t ) ( m_ >> 32 );
+}
+
+template<typename Gen>
+std::uint64_t bounded64 ( Gen & gen_, const std::uint64_t n_, const std::uint64_t t_, std::uint64_t x_ ) noexcept {
+    std::uint64_t hi;
+    while ( mul_wide ( x_, n_, hi ) < t_ ) {
+        x_ = draw64 ( gen_ );
+    }
+    return hi;
+}
+
+// Bulk draws are taken from gen_ in blocks of this many bytes.
+constexpr std::size_t batch_block_bytes = 2048;
+
+// A double in [ 0, 1 ) from the high 53 bits.
+constexpr double to_unit_double ( const std::uint64_t x_ ) noexcept {
+    return ( x_ >> 11 ) * 0x1.0p-53;
+}
+
+// A double in ( 0, 1 ), log ( ) of it is finite.
+constexpr double to_open_unit_double ( const std::uint64_t x_ ) noexcept {
+    return ( ( x_ >> 11 ) + 0.5 ) * 0x1.0p-53;
+}
+
+// Constexpr exp, log and sqrt, for the ziggurat tables only.
+constexpr double cx_exp ( const double x_ ) noexcept {
+    const double ln2 = 0.693147180559945309417;
+    const int k      = ( int ) ( x_ / ln2 + ( x_ < 0.0 ? -0.5 : 0.5 ) );
+    const double r   = x_ - k * ln2;
+    double s = 1.0, t = 1.0;
+    for ( int i = 1; i < 24; ++i ) {
+        s += t *= r / i;
+    }
+    for ( int i = 0; i < k; ++i ) {
+        s *= 2.0;
+    }
+    for ( int i = 0; i > k; --i ) {
+        s *= 0.5;
+    }
+    return s;
+}
+
+constexpr double cx_log ( double x_ ) noexcept {
+    double e = 0.0;
+    for ( ; x_ >= 2.0; x_ *= 0.5 ) {
+        e += 1.0;
+    }
+    for ( ; x_ < 1.0; x_ *= 2.0 ) {
+        e -= 1.0;
+    }
+    // log ( m ) = 2 atanh ( ( m - 1 ) / ( m + 1 ) ), m in [ 1, 2 ).
+    const double a = ( x_ - 1.0 ) / ( x_ + 1.0 ), a2 = a * a;
+    double s = 0.0, t = a;
+    for ( int i = 1; i < 64; i += 2, t *= a2 ) {
+        s += t / i;
+    }
+    return e * 0.693147180559945309417 + 2.0 * s;
+}
+
+constexpr double cx_sqrt ( const double x_ ) noexcept {
+    double y = x_ > 1.0 ? x_ : 1.0;
+    for ( int i = 0; i < 64; ++i ) {
+        y = 0.5 * ( y + x_ / y );
+    }
+    return y;
+}
+
+// The 256 layer ziggurat for the (unnormalized) normal density exp ( -x^2 / 2 )
+// (Marsaglia and Tsang, "The Ziggurat Method for Generating Random
+// Variables", 2000). Layer i spans [ 0, x [ i ] ), below it lies the
+// rectangle [ 0, x [ i + 1 ] ), k [ i ] = x [ i + 1 ] / x [ i ]. Layer 0 is the
+// base strip, including the tail beyond r, with a pseudo width of v / f ( r ).
+struct ziggurat_table {
+    static constexpr double r = 3.6541528853610088, v = 4.92867323399e-3;
+    double x [ 257 ], k [ 256 ], f [ 257 ];
+};
+
+constexpr ziggurat_table make_ziggurat_table ( ) noexcept {
+    ziggurat_table z = { };
+    z.x [ 0 ] = z.v / cx_exp ( -0.5 * z.r * z.r );
+    z.x [ 1 ] = z.r;
+    for ( int i = 1; i < 255; ++i ) {
+        z.x [ i + 1 ] = cx_sqrt ( -2.0 * cx_log ( z.v / z.x [ i ] + cx_exp ( -0.5 * z.x [ i ] * z.x [ i ] ) ) );
+    }
+    z.x [ 256 ] = 0.0;
+    for ( int i = 0; i < 256; ++i ) {
+        z.k [ i ] = z.x [ i + 1 ] / z.x [ i ];
+    }
+    for ( int i = 0; i < 257; ++i ) {
+        z.f [ i ] = cx_exp ( -0.5 * z.x [ i ] * z.x [ i ] );
+    }
+    return z;
+}
+
+inline constexpr ziggurat_table ziggurat = make_ziggurat_table ( );
+
+// The sign and 52 bits of a draw give u in [ -1, 1 ), the top 8 bits the layer.
+inline double ziggurat_u ( const std::uint64_t w_ ) noexcept {
+    double u;
+    const std::uint64_t b = ( w_ & 0x000F'FFFF'FFFF'FFFF ) | 0x4000'0000'0000'0000; // [ 2, 4 ).
+    std::memcpy ( &u, &b, sizeof ( u ) );
+    return u - 3.0;
+}
+
+// A standard normal from the draw w_, redrawing from gen_ if w_ falls
+// outside the layer rectangles.
+template<typename Gen>
+double normal ( Gen & gen_, std::uint64_t w_ ) noexcept {
+    for ( ;; w_ = draw64 ( gen_ ) ) {
+        const std::size_t i = ( std::size_t ) ( w_ >> 56 );
+        const double u = ziggurat_u ( w_ ), z = u * ziggurat.x [ i ];
+        if ( std::abs ( u ) < ziggurat.k [ i ] ) {
+            return z;
+        }
+        if ( !i ) {
+            // The tail beyond r.
+            double x, y;
+            do {
+                x = -std::log ( 1.0 - to_unit_double ( draw64 ( gen_ ) ) ) / ziggurat.r;
+                y = -std::log ( 1.0 - to_unit_double ( draw64 ( gen_ ) ) );
+            } while ( y + y < x * x );
+            return u < 0.0 ? -( ziggurat.r + x ) : ziggurat.r + x;
+        }
+        // The wedge between the rectangle and the curve.
+        if ( ziggurat.f [ i ] + to_unit_double ( draw64 ( gen_ ) ) * ( ziggurat.f [ i + 1 ] - ziggurat.f [ i ] ) < std::exp ( -0.5 * z * z ) ) {
+            return z;
+        }
+    }
+}
+} // namespace detail
+
+// A uniform integer in [ 0, n_ ), n_ > 0, without bias, as the high half of
+// a draw times n_ (Lemire, "Fast Random Integer Generation in an Interval",
+// 2019). Only if the low half is below n_ (probability n_ / 2^64) the exact
+// threshold is computed (a division) and draws below it are rejected. Gen
+// should return full range 32- or 64-bit words.
+template<typename Gen>
+std::uint64_t bounded ( Gen & gen_, const std::uint64_t n_ ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    if ( sizeof ( typename Gen::result_type ) == 4 && n_ <= 0xFFFF'FFFF ) {
+        const std::uint64_t m = ( std::uint64_t ) detail::draw32 ( gen_ ) * n_;
+        return ( std::uint32_t ) m < n_ ? detail::bounded32 ( gen_, ( std::uint32_t ) n_, ( std::uint32_t ) ( 0 - n_ ) % ( std::uint32_t ) n_, m ) : m >> 32;
+    }
+    std::uint64_t hi;
+    const std::uint64_t x = detail::draw64 ( gen_ );
+    return mul_wide ( x, n_, hi ) < n_ ? detail::bounded64 ( gen_, n_, ( 0 - n_ ) % n_, x ) : hi;
+}
+
+// Writes count_ uniform integers in [ 0, n_ ), n_ > 0, to out_, T is
+// std::uint32_t or std::uint64_t.
+//
+// The words are drawn in bulk (through Gen::generate ( ) if there is one),
+// the threshold 2^32 mod n_ (2^64 mod n_) is computed once. For n_ < 2^32
+// every 32 bits give a result, 8 (AVX2) or 16 (AVX-512) per vector multiply,
+// the (rare) lanes that hit the rejection step are redrawn one by one from
+// gen_ ( ).
+template<typename Gen, typename T>
+void bounded_batch ( Gen & gen_, const T n_, T * out_, std::size_t count_ ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    static_assert ( std::is_same<T, std::uint32_t>::value || std::is_same<T, std::uint64_t>::value, "T should be std::uint32_t or std::uint64_t" );
+    using result_type = typename Gen::result_type;
+    alignas ( 64 ) result_type buffer [ detail::batch_block_bytes / sizeof ( result_type ) ];
+    if ( ( std::uint64_t ) n_ > 0xFFFF'FFFF ) {
+        const std::uint64_t n = n_, t = ( 0 - n ) % n;
+        const std::uint64_t * w = reinterpret_cast<const std::uint64_t *> ( buffer );
+        while ( count_ ) {
+            const std::size_t m = count_ < detail::batch_block_bytes / 8 ? count_ : detail::batch_block_bytes / 8;
+            detail::generate ( gen_, buffer, m * 8 / sizeof ( result_type ) );
+            for ( std::size_t i = 0; i < m; ++i ) {
+                std::uint64_t hi;
+                out_ [ i ] = ( T ) ( mul_wide ( w [ i ], n, hi ) < t ? detail::bounded64 ( gen_, n, t, w [ i ] ) : hi );
+            }
+            out_ += m;
+            count_ -= m;
+        }
+        return;
+    }
+    const std::uint32_t n = ( std::uint32_t ) n_, t = ( 0 - n ) % n;
+    const std::uint32_t * w = reinterpret_cast<const std::uint32_t *> ( buffer );
+    while ( count_ ) {
+        const std::size_t m = count_ < detail::batch_block_bytes / 4 ? count_ : detail::batch_block_bytes / 4;
+        detail::generate ( gen_, buffer, ( m * 4 + sizeof ( result_type ) - 1 ) / sizeof ( result_type ) );
+        std::size_t i = 0, rejected = 0;
+        std::pair<std::size_t, unsigned> rejects [ detail::batch_block_bytes / 32 ];
+#if defined ( __AVX512F__ )
+        {
+            const __m512i nv = _mm512_set1_epi64 ( n ), tv = _mm512_set1_epi32 ( ( int ) t );
+            for ( ; i + 16 <= m; i += 16 ) {
+                const __m512i r  = _mm512_load_si512 ( w + i );
+                const __m512i pe = _mm512_mul_epu32 ( r, nv ), po = _mm512_mul_epu32 ( _mm512_srli_epi64 ( r, 32 ), nv );
+                const __m512i hi = _mm512_mask_blend_epi32 ( 0xAAAA, _mm512_srli_epi64 ( pe, 32 ), po );
+                const __m512i lo = _mm512_mask_blend_epi32 ( 0xAAAA, pe, _mm512_slli_epi64 ( po, 32 ) );
+                if constexpr ( sizeof ( T ) == 4 ) {
+                    _mm512_storeu_si512 ( out_ + i, hi );
+                }
+                else {
+                    _mm512_storeu_si512 ( out_ + i, _mm512_cvtepu32_epi64 ( _mm512_castsi512_si256 ( hi ) ) );
+                    _mm512_storeu_si512 ( out_ + i + 8, _mm512_cvtepu32_epi64 ( _mm512_extracti64x4_epi64 ( hi, 1 ) ) );
+                }
+                const __mmask16 r16 = _mm512_cmplt_epu32_mask ( lo, tv );
+                if ( r16 ) {
+                    rejects [ rejected++ ] = { i, r16 };
+                }
+            }
+        }
+#endif
+        {
+            const __m256i nv = _mm256_set1_epi64x ( n ), bias = _mm256_set1_epi32 ( ( int ) 0x8000'0000 ), tv = _mm256_xor_si256 ( _mm256_set1_epi32 ( ( int ) t ), bias );
+            for ( ; i + 8 <= m; i += 8 ) {
+                const __m256i r  = _mm256_load_si256 ( reinterpret_cast<const __m256i *> ( w + i ) );
+                const __m256i pe = _mm256_mul_epu32 ( r, nv ), po = _mm256_mul_epu32 ( _mm256_srli_epi64 ( r, 32 ), nv );
+                const __m256i hi = _mm256_blend_epi32 ( _mm256_srli_epi64 ( pe, 32 ), po, 0xAA );
+                const __m256i lo = _mm256_blend_epi32 ( pe, _mm256_slli_epi64 ( po, 32 ), 0xAA );
+                if constexpr ( sizeof ( T ) == 4 ) {
+                    _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( out_ + i ), hi );
+                }
+                else {
+                    _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( out_ + i ), _mm256_cvtepu32_epi64 ( _mm256_castsi256_si128 ( hi ) ) );
+                    _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( out_ + i + 4 ), _mm256_cvtepu32_epi64 ( _mm256_extracti128_si256 ( hi, 1 ) ) );
+                }
+                // Unsigned lo < t, as a signed compare with the sign bits flipped.
+                const unsigned r8 = ( unsigned ) _mm256_movemask_ps ( _mm256_castsi256_ps ( _mm256_cmpgt_epi32 ( tv, _mm256_xor_si256 ( lo, bias ) ) ) );
+                if ( r8 ) {
+                    rejects [ rejected++ ] = { i, r8 };
+                }
+            }
+        }
+        // The vector loops only note the rejected lanes, gen_ ( ) isn't
+        // called from them, which keeps the loop state in registers.
+        for ( std::size_t k = 0; k < rejected; ++k ) {
+            for ( unsigned lanes = rejects [ k ].second; lanes; lanes &= lanes - 1 ) {
+                const std::size_t j = rejects [ k ].first + tzCount ( lanes );
+                out_ [ j ] = detail::bounded32 ( gen_, n, t, ( std::uint64_t ) w [ j ] * n );
+            }
+        }
+        for ( ; i < m; ++i ) {
+            out_ [ i ] = detail::bounded32 ( gen_, n, t, ( std::uint64_t ) w [ i ] * n );
+        }
+        out_ += m;
+        count_ -= m;
+    }
+}
+
+template<typename Gen, typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, std::uint32_t>::value || std::is_same<typename Container::value_type, std::uint64_t>::value>>
+void bounded_batch ( Gen & gen_, const typename Container::value_type n_, Container & c_ ) noexcept {
+    bounded_batch ( gen_, n_, std::data ( c_ ), std::size ( c_ ) );
+}
+
+// Writes n_ uniform doubles in [ 0, 1 ) to out_, multiples of 2^-52.
+//
+// The high 52 bits of every 64-bit word are or'ed into the mantissa of 1.0,
+// the result in [ 1, 2 ) minus 1.0 is the value. No conversion instruction is
+// involved, a vector of words gives a vector of doubles in 3 instructions.
+template<typename Gen>
+void uniform_double_batch ( Gen & gen_, double * out_, std::size_t n_ ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    using result_type = typename Gen::result_type;
+    alignas ( 64 ) result_type buffer [ detail::batch_block_bytes / sizeof ( result_type ) ];
+    const std::uint64_t * w = reinterpret_cast<const std::uint64_t *> ( buffer );
+    while ( n_ ) {
+        const std::size_t m = n_ < detail::batch_block_bytes / 8 ? n_ : detail::batch_block_bytes / 8;
+        detail::generate ( gen_, buffer, m * 8 / sizeof ( result_type ) );
+        std::size_t i = 0;
+#if defined ( __AVX512F__ )
+        {
+            const __m512i one = _mm512_set1_epi64 ( 0x3FF0'0000'0000'0000 );
+            for ( ; i + 8 <= m; i += 8 ) {
+                const __m512d d = _mm512_castsi512_pd ( _mm512_or_si512 ( _mm512_srli_epi64 ( _mm512_load_si512 ( w + i ), 12 ), one ) );
+                _mm512_storeu_pd ( out_ + i, _mm512_sub_pd ( d, _mm512_set1_pd ( 1.0 ) ) );
+            }
+        }
+#endif
+        {
+            const __m256i one = _mm256_set1_epi64x ( 0x3FF0'0000'0000'0000 );
+            for ( ; i + 4 <= m; i += 4 ) {
+                const __m256d d = _mm256_castsi256_pd ( _mm256_or_si256 ( _mm256_srli_epi64 ( _mm256_load_si256 ( reinterpret_cast<const __m256i *> ( w + i ) ), 12 ), one ) );
+                _mm256_storeu_pd ( out_ + i, _mm256_sub_pd ( d, _mm256_set1_pd ( 1.0 ) ) );
+            }
+        }
+        for ( ; i < m; ++i ) {
+            out_ [ i ] = ( w [ i ] >> 12 ) * 0x1.0p-52;
+        }
+        out_ += m;
+        n_ -= m;
+    }
+}
+
+template<typename Gen, typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, double>::value>>
+void uniform_double_batch ( Gen & gen_, Container & c_ ) noexcept {
+    uniform_double_batch ( gen_, std::data ( c_ ), std::size ( c_ ) );
+}
+
+// Writes n_ uniform floats in [ 0, 1 ) to out_, multiples of 2^-23, one
+// float per 32 bits drawn.
+template<typename Gen>
+void uniform_float_batch ( Gen & gen_, float * out_, std::size_t n_ ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    using result_type = typename Gen::result_type;
+    alignas ( 64 ) result_type buffer [ detail::batch_block_bytes / sizeof ( result_type ) ];
+    const std::uint32_t * w = reinterpret_cast<const std::uint32_t *> ( buffer );
+    while ( n_ ) {
+        const std::size_t m = n_ < detail::batch_block_bytes / 4 ? n_ : detail::batch_block_bytes / 4;
+        detail::generate ( gen_, buffer, ( m * 4 + sizeof ( result_type ) - 1 ) / sizeof ( result_type ) );
+        std::size_t i = 0;
+#if defined ( __AVX512F__ )
+        {
+            const __m512i one = _mm512_set1_epi32 ( 0x3F80'0000 );
+            for ( ; i + 16 <= m; i += 16 ) {
+                const __m512 f = _mm512_castsi512_ps ( _mm512_or_si512 ( _mm512_srli_epi32 ( _mm512_load_si512 ( w + i ), 9 ), one ) );
+                _mm512_storeu_ps ( out_ + i, _mm512_sub_ps ( f, _mm512_set1_ps ( 1.0f ) ) );
+            }
+        }
+#endif
+        {
+            const __m256i one = _mm256_set1_epi32 ( 0x3F80'0000 );
+            for ( ; i + 8 <= m; i += 8 ) {
+                const __m256 f = _mm256_castsi256_ps ( _mm256_or_si256 ( _mm256_srli_epi32 ( _mm256_load_si256 ( reinterpret_cast<const __m256i *> ( w + i ) ), 9 ), one ) );
+                _mm256_storeu_ps ( out_ + i, _mm256_sub_ps ( f, _mm256_set1_ps ( 1.0f ) ) );
+            }
+        }
+        for ( ; i < m; ++i ) {
+            out_ [ i ] = ( w [ i ] >> 9 ) * 0x1.0p-23f;
+        }
+        out_ += m;
+        n_ -= m;
+    }
+}
+
+template<typename Gen, typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, float>::value>>
+void uniform_float_batch ( Gen & gen_, Container & c_ ) noexcept {
+    uniform_float_batch ( gen_, std::data ( c_ ), std::size ( c_ ) );
+}
+
+// A standard normal variate (256 layer ziggurat).
+template<typename Gen>
+double normal ( Gen & gen_ ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    return detail::normal ( gen_, detail::draw64 ( gen_ ) );
+}
+
+// Writes n_ normal variates with mean_ and stddev_ to out_.
+//
+// A 256 layer ziggurat, the tables are computed at compile time. Every
+// 64-bit word gives a layer (top 8 bits) and a signed uniform u (sign and
+// low 52 bits, built as in uniform_double_batch ( )). The layer widths x
+// and ratios k are gathered, u * x is accepted if | u | < k, which holds
+// for about 98.5% of the words. The vector loop only notes the other
+// lanes, these go through the wedge and tail tests one by one.
+template<typename Gen>
+void normal_batch ( Gen & gen_, double * out_, std::size_t n_, const double mean_ = 0.0, const double stddev_ = 1.0 ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    using result_type = typename Gen::result_type;
+    alignas ( 64 ) result_type buffer [ detail::batch_block_bytes / sizeof ( result_type ) ];
+    const std::uint64_t * w = reinterpret_cast<const std::uint64_t *> ( buffer );
+    while ( n_ ) {
+        const std::size_t m = n_ < detail::batch_block_bytes / 8 ? n_ : detail::batch_block_bytes / 8;
+        detail::generate ( gen_, buffer, m * 8 / sizeof ( result_type ) );
+        std::size_t i = 0, rejected = 0;
+        std::pair<std::size_t, unsigned> rejects [ detail::batch_block_bytes / 32 ];
+#if defined ( __AVX512F__ )
+        {
+            const __m512i mantissa = _mm512_set1_epi64 ( 0x000F'FFFF'FFFF'FFFF ), two = _mm512_set1_epi64 ( 0x4000'0000'0000'0000 );
+            const __m512d mean = _mm512_set1_pd ( mean_ ), stddev = _mm512_set1_pd ( stddev_ );
+            for ( ; i + 8 <= m; i += 8 ) {
+                const __m512i r = _mm512_load_si512 ( w + i ), l = _mm512_srli_epi64 ( r, 56 );
+                const __m512d u = _mm512_sub_pd ( _mm512_castsi512_pd ( _mm512_or_si512 ( _mm512_and_si512 ( r, mantissa ), two ) ), _mm512_set1_pd ( 3.0 ) );
+                const __m512d x = _mm512_i64gather_pd ( l, detail::ziggurat.x, 8 ), k = _mm512_i64gather_pd ( l, detail::ziggurat.k, 8 );
+                _mm512_storeu_pd ( out_ + i, _mm512_add_pd ( _mm512_mul_pd ( _mm512_mul_pd ( u, x ), stddev ), mean ) );
+                const __mmask8 r8 = _mm512_cmp_pd_mask ( _mm512_abs_pd ( u ), k, _CMP_NLT_UQ );
+                if ( r8 ) {
+                    rejects [ rejected++ ] = { i, r8 };
+                }
+            }
+        }
+#endif
+        {
+            const __m256i mantissa = _mm256_set1_epi64x ( 0x000F'FFFF'FFFF'FFFF ), two = _mm256_set1_epi64x ( 0x4000'0000'0000'0000 );
+            const __m256d mean = _mm256_set1_pd ( mean_ ), stddev = _mm256_set1_pd ( stddev_ ), sign = _mm256_set1_pd ( -0.0 );
+            for ( ; i + 4 <= m; i += 4 ) {
+                const __m256i r = _mm256_load_si256 ( reinterpret_cast<const __m256i *> ( w + i ) ), l = _mm256_srli_epi64 ( r, 56 );
+                const __m256d u = _mm256_sub_pd ( _mm256_castsi256_pd ( _mm256_or_si256 ( _mm256_and_si256 ( r, mantissa ), two ) ), _mm256_set1_pd ( 3.0 ) );
+                const __m256d x = _mm256_i64gather_pd ( detail::ziggurat.x, l, 8 ), k = _mm256_i64gather_pd ( detail::ziggurat.k, l, 8 );
+                _mm256_storeu_pd ( out_ + i, _mm256_add_pd ( _mm256_mul_pd ( _mm256_mul_pd ( u, x ), stddev ), mean ) );
+                const unsigned r4 = ( unsigned ) _mm256_movemask_pd ( _mm256_cmp_pd ( _mm256_andnot_pd ( sign, u ), k, _CMP_NLT_UQ ) );
+                if ( r4 ) {
+                    rejects [ rejected++ ] = { i, r4 };
+                }
+            }
+        }
+        for ( std::size_t j = 0; j < rejected; ++j ) {
+            for ( unsigned lanes = rejects [ j ].second; lanes; lanes &= lanes - 1 ) {
+                const std::size_t l = rejects [ j ].first + tzCount ( lanes );
+                out_ [ l ] = mean_ + stddev_ * detail::normal ( gen_, w [ l ] );
+            }
+        }
+        for ( ; i < m; ++i ) {
+            out_ [ i ] = mean_ + stddev_ * detail::normal ( gen_, w [ i ] );
+        }
+        out_ += m;
+        n_ -= m;
+    }
+}
+
+template<typename Gen, typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, double>::value>>
+void normal_batch ( Gen & gen_, Container & c_, const double mean_ = 0.0, const double stddev_ = 1.0 ) noexcept {
+    normal_batch ( gen_, std::data ( c_ ), std::size ( c_ ), mean_, stddev_ );
+}
+} // namespace iu
@@ -0,0 +1,446 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <immintrin.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "integer_utils.hpp"
+#include "random.hpp"
+#include "stream_pool.hpp"
+
+namespace iu {
+
+namespace detail {
+
+// Counter based generators discard ( ) with one argument.
+template<typename Gen, typename = void>
+struct has_discard_n : std::false_type { };
+template<typename Gen>
+struct has_discard_n<Gen, std::void_t<decltype ( std::declval<Gen &> ( ).discard ( std::uint64_t { } ) )>> : std::true_type { };
+
+// Probabilities.
+
+// Two-sided p-value of a standard normal z.
+inline double normal_p ( const double z_ ) noexcept {
+    return std::erfc ( std::abs ( z_ ) / std::sqrt ( 2.0 ) );
+}
+
+// The regularized upper incomplete gamma function Q ( a, x ), series for
+// x < a + 1, continued fraction (modified Lentz) otherwise.
+inline double gamma_q ( const double a_, const double x_ ) noexcept {
+    if ( x_ <= 0.0 ) {
+        return 1.0;
+    }
+    const double g = a_ * std::log ( x_ ) - x_ - std::lgamma ( a_ );
+    if ( x_ < a_ + 1.0 ) {
+        double s = 1.0 / a_, t = s;
+        for ( double n = a_ + 1.0; std::abs ( t ) > std::abs ( s ) * 1e-15; n += 1.0 ) {
+            s += t *= x_ / n;
+        }
+        return 1.0 - s * std::exp ( g );
+    }
+    double b = x_ + 1.0 - a_, c = 1e300, d = 1.0 / b, h = d;
+    for ( int i = 1; i < 1000; ++i ) {
+        const double an = -i * ( i - a_ );
+        b += 2.0;
+        d = an * d + b;
+        d = std::abs ( d ) < 1e-300 ? 1e-300 : d;
+        c = b + an / c;
+        c = std::abs ( c ) < 1e-300 ? 1e-300 : c;
+        d = 1.0 / d;
+        const double r = d * c;
+        h *= r;
+        if ( std::abs ( r - 1.0 ) < 1e-15 ) {
+            break;
+        }
+    }
+    return std::exp ( g ) * h;
+}
+
+struct chi2_result {
+    double statistic, p_value;
+};
+
+// Pearson's chi-square of counts against probabilities, adjacent bins are
+// merged (left to right) until every bin expects at least 5.
+inline chi2_result chi2 ( const std::uint64_t * counts_, const double * p_, const std::size_t n_ ) noexcept {
+    double total = 0.0;
+    for ( std::size_t i = 0; i < n_; ++i ) {
+        total += ( double ) counts_ [ i ];
+    }
+    double x = 0.0, o = 0.0, e = 0.0;
+    int bins = 0;
+    for ( std::size_t i = 0; i < n_; ++i ) {
+        o += ( double ) counts_ [ i ];
+        e += p_ [ i ] * total;
+        if ( e >= 5.0 || i + 1 == n_ ) {
+            if ( e > 0.0 ) {
+                x += ( o - e ) * ( o - e ) / e;
+                ++bins;
+            }
+            o = e = 0.0;
+        }
+    }
+    return { x, bins > 1 ? gamma_q ( 0.5 * ( bins - 1 ), 0.5 * x ) : 0.5 }; // Too few samples to tell.
+}
+
+// The rank counts against gf2_rank_p, chi-square, or while the rank
+// n - 3 and less bin expects less than 5, the binomial tail of that bin
+// (a few megabytes of a generator that fails should fail).
+inline chi2_result rank_test ( const std::uint64_t * counts_, const double * p_ ) noexcept {
+    const std::uint64_t n = counts_ [ 0 ] + counts_ [ 1 ] + counts_ [ 2 ] + counts_ [ 3 ], k = counts_ [ 3 ];
+    if ( n * p_ [ 3 ] >= 5.0 ) {
+        return chi2 ( counts_, p_, 4 );
+    }
+    double tail = 0.0;
+    for ( std::uint64_t i = k; i <= n; ++i ) {
+        tail += std::exp ( std::lgamma ( n + 1.0 ) - std::lgamma ( i + 1.0 ) - std::lgamma ( n - i + 1.0 ) + i * std::log ( p_ [ 3 ] ) + ( n - i ) * std::log1p ( -p_ [ 3 ] ) );
+    }
+    return { ( double ) k, k ? std::min ( tail, 1.0 ) : 0.5 };
+}
+
+// Kernels.
+
+// Popcount of 64 bytes, VPOPCNTDQ, or nibble lookups and sad (W. Mula).
+inline int popcount_64_bytes ( const void * p_ ) noexcept {
+#if defined ( __AVX512VPOPCNTDQ__ )
+    return ( int ) _mm512_reduce_add_epi64 ( _mm512_popcnt_epi64 ( _mm512_loadu_si512 ( p_ ) ) );
+#else
+    const __m256i lut = _mm256_setr_epi8 ( 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 ), low = _mm256_set1_epi8 ( 0x0F );
+    const auto count = [ & ] ( const __m256i v_ ) {
+        return _mm256_add_epi8 ( _mm256_shuffle_epi8 ( lut, _mm256_and_si256 ( v_, low ) ), _mm256_shuffle_epi8 ( lut, _mm256_and_si256 ( _mm256_srli_epi16 ( v_, 4 ), low ) ) );
+    };
+    const __m256i * p = reinterpret_cast<const __m256i *> ( p_ );
+    const __m256i s   = _mm256_sad_epu8 ( _mm256_add_epi8 ( count ( _mm256_loadu_si256 ( p ) ), count ( _mm256_loadu_si256 ( p + 1 ) ) ), _mm256_setzero_si256 ( ) );
+    const __m128i h   = _mm_add_epi64 ( _mm256_castsi256_si128 ( s ), _mm256_extracti128_si256 ( s, 1 ) );
+    return ( int ) ( _mm_cvtsi128_si64 ( h ) + _mm_extract_epi64 ( h, 1 ) );
+#endif
+}
+
+// Bit i of out_ [ i / 64 ] is the lowest bit of v_ [ i ], n_ a multiple of 64.
+template<typename T>
+void lowest_bits ( const T * v_, const std::size_t n_, std::uint64_t * out_ ) noexcept {
+    for ( std::size_t i = 0; i < n_; i += 64 ) {
+        std::uint64_t w = 0;
+        if constexpr ( sizeof ( T ) == 8 ) {
+            for ( int j = 0; j < 64; j += 4 ) {
+                const __m256i v = _mm256_slli_epi64 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( v_ + i + j ) ), 63 );
+                w |= std::uint64_t ( _mm256_movemask_pd ( _mm256_castsi256_pd ( v ) ) ) << j;
+            }
+        }
+        else if constexpr ( sizeof ( T ) == 4 ) {
+            for ( int j = 0; j < 64; j += 8 ) {
+                const __m256i v = _mm256_slli_epi32 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( v_ + i + j ) ), 31 );
+                w |= std::uint64_t ( _mm256_movemask_ps ( _mm256_castsi256_ps ( v ) ) ) << j;
+            }
+        }
+        else {
+            for ( int j = 0; j < 64; ++j ) {
+                w |= std::uint64_t ( ( std::uint64_t ) v_ [ i + j ] & 1 ) << j;
+            }
+        }
+        out_ [ i / 64 ] = w;
+    }
+}
+
+// Rank over GF(2) of a square matrix of W 64-bit words per row (64 W rows),
+// Gaussian elimination, a row operation is a single vector xor.
+template<int W>
+int gf2_rank ( std::uint64_t * m_ ) noexcept {
+    constexpr int n = 64 * W;
+    int rank        = 0;
+    for ( int col = 0; col < n && rank < n; ++col ) {
+        const int w = col / 64;
+        const std::uint64_t bit = std::uint64_t { 1 } << ( col % 64 );
+        int p = rank;
+        while ( p < n && !( m_ [ p * W + w ] & bit ) ) {
+            ++p;
+        }
+        if ( p == n ) {
+            continue;
+        }
+        std::uint64_t * pivot = m_ + rank * W;
+        if ( p != rank ) {
+            for ( int i = 0; i < W; ++i ) {
+                std::swap ( pivot [ i ], m_ [ p * W + i ] );
+            }
+        }
+        for ( int r = p + 1; r < n; ++r ) {
+            std::uint64_t * row = m_ + r * W;
+            if ( row [ w ] & bit ) {
+                if constexpr ( W == 4 ) {
+                    _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( row ), _mm256_xor_si256 ( _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( row ) ), _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( pivot ) ) ) );
+                }
+                else {
+                    for ( int i = 0; i < W; ++i ) {
+                        row [ i ] ^= pivot [ i ];
+                    }
+                }
+            }
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+// The probabilities of rank n, n - 1, n - 2 and less of a random n x n
+// matrix over GF(2), for large n (exact to 2^-64 from n = 64).
+constexpr double gf2_rank_p [ 4 ] = { 0.2887880950866024, 0.5775761901732048, 0.1283502644829344, 0.0052854502572584 };
+
+// The tallies of the tests, per thread, added up at the end.
+struct smoketest_tallies {
+
+    static constexpr int gap_bins = 64, birthday_bins = 24;
+
+    std::uint64_t ones [ 513 ] = { }; // Popcounts of 512-bit blocks.
+    std::uint64_t gaps [ gap_bins ] = { }; // The last bin is gaps_bins - 1 and up.
+    std::uint64_t birthdays [ birthday_bins ] = { };
+    std::uint64_t rank64 [ 4 ] = { }, rank256 [ 4 ] = { };
+
+    smoketest_tallies & operator += ( const smoketest_tallies & rhs_ ) noexcept {
+        for ( int i = 0; i < 513; ++i ) {
+            ones [ i ] += rhs_.ones [ i ];
+        }
+        for ( int i = 0; i < gap_bins; ++i ) {
+            gaps [ i ] += rhs_.gaps [ i ];
+        }
+        for ( int i = 0; i < birthday_bins; ++i ) {
+            birthdays [ i ] += rhs_.birthdays [ i ];
+        }
+        for ( int i = 0; i < 4; ++i ) {
+            rank64 [ i ] += rhs_.rank64 [ i ];
+            rank256 [ i ] += rhs_.rank256 [ i ];
+        }
+        return *this;
+    }
+};
+} // namespace detail
+
+struct smoketest_result {
+    const char * name;
+    double statistic, p_value;
+};
+
+// A quick in-process battery for generators, it catches gross defects (as
+// the BRank failures of the + generators on their lowest bit, after 1.5
+// to 2 MB) in seconds, not the subtle ones BigCrush and long PractRand
+// runs find. The output is a stream of bytes, the tests:
+//
+//   - monobit, the ones in the stream, a z-test.
+//   - frequency, the popcounts of the 512-bit blocks, against binomial
+//     ( 512, 1/2 ), chi-square.
+//   - gap, the gaps between the 32-bit words with the top 2 bits 0,
+//     against geometric ( 1/4 ), chi-square.
+//   - birthday spacings, 1024 birthdays (the top 26 bits of 32-bit words)
+//     in 2^26 days, the duplicate spacings against Poisson ( 4 ) (Marsaglia,
+//     "A Current View of Random Number Generators", 1985), chi-square. One
+//     sample per block (2^16 values).
+//   - rank 64x64, the ranks over GF(2) of the matrices of 64 64-bit words,
+//     one per 4 KB, chi-square.
+//   - rank 256x256 low bit, of the matrices of the lowest bits of 2^16
+//     consecutive values (the values, not the words), chi-square.
+//
+// The stream is split in as many parts as threads, part t starts at
+// value t * size / threads (discard ( )), without discard ( ) the parts
+// are t times jump ( )'ed copies, without either there is one thread.
+// The popcounts are SIMD, VPOPCNTDQ with AVX512-VPOPCNTDQ, nibble lookups
+// otherwise, a row operation of the 256 x 256 eliminations is one AVX2
+// xor.
+class rng_smoketest {
+
+    static constexpr std::size_t block_values = std::size_t { 1 } << 16;
+
+    template<typename Gen>
+    static void test_part ( Gen & gen_, const std::size_t blocks_, detail::smoketest_tallies & t_ ) {
+        using result_type = typename Gen::result_type;
+        constexpr std::size_t block_bytes = block_values * sizeof ( result_type ), words = block_bytes / 4;
+        std::vector<result_type> values ( block_values );
+        std::vector<std::uint32_t> days ( 1024 ), spacings ( 1024 );
+        alignas ( 32 ) std::uint64_t m [ 256 * 4 ];
+        std::uint64_t gap = 0;
+        bool counting     = false;
+        for ( std::size_t b = 0; b < blocks_; ++b ) {
+            detail::generate ( gen_, values.data ( ), block_values );
+            const std::uint8_t * bytes = reinterpret_cast<const std::uint8_t *> ( values.data ( ) );
+            // Monobit and frequency.
+            for ( std::size_t i = 0; i < block_bytes; i += 64 ) {
+                ++t_.ones [ detail::popcount_64_bytes ( bytes + i ) ];
+            }
+            // Gap, the hits of 64 words at a time as a mask.
+            for ( std::size_t i = 0; i < words; i += 64 ) {
+                std::uint64_t hits = 0;
+                for ( int j = 0; j < 64; j += 8 ) {
+                    const __m256i v = _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( bytes + 4 * ( i + j ) ) );
+                    const __m256i h = _mm256_cmpeq_epi32 ( _mm256_and_si256 ( v, _mm256_set1_epi32 ( ( int ) 0xC000'0000 ) ), _mm256_setzero_si256 ( ) );
+                    hits |= std::uint64_t ( ( unsigned ) _mm256_movemask_ps ( _mm256_castsi256_ps ( h ) ) ) << j;
+                }
+                int at = 0;
+                while ( hits ) {
+                    const int z = tzCount ( hits );
+                    gap += z - at;
+                    if ( counting ) {
+                        ++t_.gaps [ gap < detail::smoketest_tallies::gap_bins - 1 ? gap : detail::smoketest_tallies::gap_bins - 1 ];
+                    }
+                    counting = true;
+                    gap      = 0;
+                    at       = z + 1;
+                    hits &= hits - 1;
+                }
+                gap += 64 - at;
+            }
+            // Birthday spacings.
+            for ( int i = 0; i < 1024; ++i ) {
+                std::uint32_t w;
+                std::memcpy ( &w, bytes + 4 * i, 4 );
+                days [ i ] = w >> 6;
+            }
+            std::sort ( days.begin ( ), days.end ( ) );
+            spacings [ 0 ] = days [ 0 ];
+            for ( int i = 1; i < 1024; ++i ) {
+                spacings [ i ] = days [ i ] - days [ i - 1 ];
+            }
+            std::sort ( spacings.begin ( ), spacings.end ( ) );
+            int duplicates = 0;
+            for ( int i = 1; i < 1024; ++i ) {
+                duplicates += spacings [ i ] == spacings [ i - 1 ];
+            }
+            ++t_.birthdays [ duplicates < detail::smoketest_tallies::birthday_bins - 1 ? duplicates : detail::smoketest_tallies::birthday_bins - 1 ];
+            // Rank 64x64, one matrix per 4 KB.
+            for ( std::size_t i = 0; i < block_bytes; i += 4096 ) {
+                std::memcpy ( m, bytes + i, 512 );
+                const int r = 64 - detail::gf2_rank<1> ( m );
+                ++t_.rank64 [ r < 3 ? r : 3 ];
+            }
+            // Rank 256x256 of the lowest bits.
+            detail::lowest_bits ( values.data ( ), block_values, m );
+            const int r = 256 - detail::gf2_rank<4> ( m );
+            ++t_.rank256 [ r < 3 ? r : 3 ];
+        }
+    }
+
+    public:
+
+    // Tests bytes_ bytes (rounded down to 2^16 values, at least 2^16
+    // values) on threads_ threads (0 for all cores).
+    explicit rng_smoketest ( const std::size_t bytes_ = std::size_t { 1 } << 28, const unsigned threads_ = 0 ) noexcept :
+        m_bytes { bytes_ }, m_threads { threads_ ? threads_ : std::max ( std::thread::hardware_concurrency ( ), 1u ) } { }
+
+    template<typename Gen>
+    std::vector<smoketest_result> run ( const Gen & gen_ ) const {
+        const std::size_t blocks = std::max<std::size_t> ( m_bytes / ( block_values * sizeof ( typename Gen::result_type ) ), 1 );
+        unsigned threads = ( unsigned ) std::min<std::size_t> ( m_threads, blocks );
+        constexpr bool discards = detail::has_discard<Gen>::value || detail::has_discard_n<Gen>::value;
+        if constexpr ( !discards && !detail::has_jump<Gen>::value ) {
+            threads = 1;
+        }
+        std::vector<detail::smoketest_tallies> tallies ( threads );
+        detail::parallel_for ( threads, [ & ] ( const unsigned t_ ) {
+            Gen gen = gen_;
+            const std::size_t first = blocks * t_ / threads, last = blocks * ( t_ + 1 ) / threads;
+            if constexpr ( detail::has_discard<Gen>::value ) {
+                gen.discard ( 0, first * block_values );
+            }
+            else if constexpr ( detail::has_discard_n<Gen>::value ) {
+                gen.discard ( first * block_values );
+            }
+            else if constexpr ( detail::has_jump<Gen>::value ) {
+                for ( unsigned i = 0; i < t_; ++i ) {
+                    gen.jump ( );
+                }
+            }
+            test_part ( gen, last - first, tallies [ t_ ] );
+        } );
+        for ( unsigned t = 1; t < threads; ++t ) {
+            tallies [ 0 ] += tallies [ t ];
+        }
+        return report ( tallies [ 0 ] );
+    }
+
+    // A p-value below alpha_, or above 1 - alpha_, is a failure.
+    static bool passed ( const smoketest_result & r_, const double alpha_ = 1e-6 ) noexcept {
+        return r_.p_value >= alpha_ && r_.p_value <= 1.0 - alpha_;
+    }
+
+    static bool passed ( const std::vector<smoketest_result> & r_, const double alpha_ = 1e-6 ) noexcept {
+        return std::all_of ( r_.begin ( ), r_.end ( ), [ alpha_ ] ( const smoketest_result & r ) { return passed ( r, alpha_ ); } );
+    }
+
+    private:
+
+    static std::vector<smoketest_result> report ( const detail::smoketest_tallies & t_ ) {
+        std::vector<smoketest_result> r;
+        // Monobit.
+        double blocks = 0.0, ones = 0.0;
+        for ( int i = 0; i <= 512; ++i ) {
+            blocks += ( double ) t_.ones [ i ];
+            ones += ( double ) t_.ones [ i ] * i;
+        }
+        const double z = ( 2.0 * ones - 512.0 * blocks ) / std::sqrt ( 512.0 * blocks );
+        r.push_back ( { "monobit", z, detail::normal_p ( z ) } );
+        // Frequency.
+        double p [ 513 ];
+        for ( int i = 0; i <= 512; ++i ) {
+            p [ i ] = std::exp ( std::lgamma ( 513.0 ) - std::lgamma ( i + 1.0 ) - std::lgamma ( 513.0 - i ) - 512.0 * std::log ( 2.0 ) );
+        }
+        detail::chi2_result c = detail::chi2 ( t_.ones, p, 513 );
+        r.push_back ( { "frequency", c.statistic, c.p_value } );
+        // Gap.
+        constexpr int gb = detail::smoketest_tallies::gap_bins;
+        for ( int i = 0; i < gb - 1; ++i ) {
+            p [ i ] = 0.25 * std::pow ( 0.75, i );
+        }
+        p [ gb - 1 ] = std::pow ( 0.75, gb - 1 );
+        c            = detail::chi2 ( t_.gaps, p, gb );
+        r.push_back ( { "gap", c.statistic, c.p_value } );
+        // Birthday spacings.
+        constexpr int bb = detail::smoketest_tallies::birthday_bins;
+        double tail      = 1.0;
+        for ( int i = 0; i < bb - 1; ++i ) {
+            p [ i ] = std::exp ( i * std::log ( 4.0 ) - 4.0 - std::lgamma ( i + 1.0 ) );
+            tail -= p [ i ];
+        }
+        p [ bb - 1 ] = std::max ( tail, 0.0 );
+        c            = detail::chi2 ( t_.birthdays, p, bb );
+        r.push_back ( { "birthday spacings", c.statistic, c.p_value } );
+        // Ranks.
+        c = detail::rank_test ( t_.rank64, detail::gf2_rank_p );
+        r.push_back ( { "rank 64x64", c.statistic, c.p_value } );
+        c = detail::rank_test ( t_.rank256, detail::gf2_rank_p );
+        r.push_back ( { "rank 256x256 low bit", c.statistic, c.p_value } );
+        return r;
+    }
+
+    std::size_t m_bytes;
+    unsigned m_threads;
+};
+} // namespace iu
@@ -0,0 +1,398 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <immintrin.h>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "random.hpp"
+#include "stream_pool.hpp"
+
+namespace iu {
+
+namespace detail {
+
+// Draws m_ indices, out_ [ c ] uniform in [ 0, r_ - c ), r_ - m_ > 0.
+//
+// As long as the product p of the ranges fits in 64 bits, one draw x gives
+// all of them, x * r_ gives the first index in the high half, the low half
+// times r_ - 1 the second, etc., the low half that is left over is compared
+// against 2^64 mod p (Brackett-Rozinsky and Lemire, "Batched Ranged Random
+// Integer Generation", 2024). The ranges per draw are limited to keep p
+// below about 2^56, then the left over is rarely below p and 2^64 mod p
+// (a division) is rarely needed. Up to 8 indices per draw for ranges up
+// to 128.
+template<typename Gen>
+void shuffle_indices ( Gen & gen_, std::uint64_t r_, std::size_t m_, std::size_t * out_ ) noexcept {
+    // The largest range for which c + 2 indices are taken from a draw.
+    constexpr std::uint64_t limit [ 7 ] = { 1 << 28, 1 << 18, 1 << 14, 1 << 11, 1 << 9, 1 << 8, 1 << 7 };
+    while ( m_ ) {
+        std::size_t k = 1;
+        while ( k < 8 && k < m_ && r_ <= limit [ k - 1 ] ) {
+            ++k;
+        }
+        std::uint64_t p = r_;
+        for ( std::size_t c = 1; c < k; ++c ) {
+            p *= r_ - c;
+        }
+        for ( ;; ) {
+            std::uint64_t x = draw64 ( gen_ ), hi;
+            for ( std::size_t c = 0; c < k; ++c ) {
+                x         = mul_wide ( x, r_ - c, hi );
+                out_ [ c ] = ( std::size_t ) hi;
+            }
+            if ( x >= p || x >= ( 0 - p ) % p ) {
+                break;
+            }
+        }
+        out_ += k;
+        r_ -= k;
+        m_ -= k;
+    }
+}
+
+// The MergeShuffle merge (Bacher, Bodini, Hollender and Lumbroso,
+// "MergeShuffle: A Very Fast, Parallel Random Permutation Algorithm",
+// 2015). With data_ [ 0, n1_ ) and data_ [ n1_, n_ ) shuffled, the
+// front is filled by picking either side on a coin flip, until one side
+// runs out, the rest is put in place by Fisher-Yates insertions.
+template<typename T, typename Gen>
+void merge_shuffled ( T * data_, const std::size_t n1_, const std::size_t n_, Gen & gen_ ) noexcept ( std::is_nothrow_swappable<T>::value ) {
+    std::size_t i = 0, j = n1_;
+    for ( std::uint64_t bits = 0, left = 0;; ++i, bits >>= 1, --left ) {
+        if ( !left ) {
+            bits = draw64 ( gen_ );
+            left = 64;
+        }
+        // No branch on the coin (it would be mispredicted half of the
+        // time), k is j on a 1, i on a 0 (a swap with itself).
+        const std::size_t right = ( std::size_t ) bits & 1, mask = 0 - right, k = i + ( ( j - i ) & mask );
+        if ( k == j + ( ( n_ - j ) & mask ) ) {
+            break; // The side to take from is empty.
+        }
+        std::swap ( data_ [ i ], data_ [ k ] );
+        j += right;
+    }
+    for ( ; i < n_; ++i ) {
+        std::swap ( data_ [ i ], data_ [ bounded ( gen_, i + 1 ) ] );
+    }
+}
+} // namespace detail
+
+// The Fisher-Yates shuffle takes its indices in batches of this many, the
+// swap targets of a batch are prefetched before the swaps.
+constexpr std::size_t shuffle_batch_size = 32;
+
+// Shuffles data_ [ 0, n_ ) (Fisher-Yates), all n_! orders are equally likely.
+//
+// The indices are drawn a batch at a time, with several indices per 64-bit
+// draw for ranges up to 2^28 (2 up to 2^28, 3 up to 2^18, ... 8 up to
+// 2^7), and the swap targets of a batch are prefetched, for arrays that
+// don't fit in the cache the misses overlap.
+template<typename T, typename Gen>
+void shuffle ( T * data_, std::size_t n_, Gen & gen_ ) noexcept ( std::is_nothrow_swappable<T>::value ) {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    std::size_t j [ shuffle_batch_size ];
+    while ( n_ > 1 ) {
+        const std::size_t m = n_ - 1 < shuffle_batch_size ? n_ - 1 : shuffle_batch_size;
+        detail::shuffle_indices ( gen_, n_, m, j );
+        for ( std::size_t k = 0; k < m; ++k ) {
+            _mm_prefetch ( reinterpret_cast<const char *> ( data_ + j [ k ] ), _MM_HINT_T0 );
+        }
+        for ( std::size_t k = 0; k < m; ++k ) {
+            std::swap ( data_ [ n_ - 1 - k ], data_ [ j [ k ] ] );
+        }
+        n_ -= m;
+    }
+}
+
+template<typename Container, typename Gen>
+void shuffle ( Container & c_, Gen & gen_ ) noexcept ( std::is_nothrow_swappable<typename Container::value_type>::value ) {
+    shuffle ( std::data ( c_ ), std::size ( c_ ), gen_ );
+}
+
+// The parallel shuffle cuts the array in at most max_shuffle_blocks
+// blocks of at least shuffle_block_size elements.
+constexpr std::size_t shuffle_block_size = std::size_t { 1 } << 16, max_shuffle_blocks = 64;
+
+// Shuffles data_ [ 0, n_ ) with threads_ threads (MergeShuffle), the order
+// doesn't depend on the number of threads.
+//
+// The array is cut in a power of 2 number of blocks (depending on n_ only),
+// block b is shuffled with gen_ jumped b times, then neighbouring blocks
+// are merged pairwise (at every level, the merges run in parallel), the
+// merge of blocks b and b + s continues the stream of block b. The final
+// merge is a single sequential pass. gen_ is left jumped once for every
+// block. Below 2 shuffle_block_size elements this is shuffle ( data_, n_,
+// gen_ ).
+template<typename T, typename Gen>
+void shuffle ( T * data_, const std::size_t n_, Gen & gen_, unsigned threads_ ) {
+    static_assert ( detail::has_jump<Gen>::value, "Gen should have jump ( )" );
+    std::size_t blocks = 1;
+    while ( blocks < max_shuffle_blocks && n_ / ( 2 * blocks ) >= shuffle_block_size ) {
+        blocks *= 2;
+    }
+    if ( blocks == 1 ) {
+        shuffle ( data_, n_, gen_ );
+        return;
+    }
+    threads_ = threads_ ? threads_ : 1;
+    struct alignas ( 64 ) padded_generator {
+        Gen gen;
+    };
+    std::vector<padded_generator> gens;
+    gens.reserve ( blocks );
+    for ( std::size_t b = 0; b < blocks; ++b ) {
+        gens.push_back ( { gen_ } );
+        gen_.jump ( );
+    }
+    const auto first = [ & ] ( const std::size_t b_ ) noexcept { return b_ * n_ / blocks; };
+    const auto in_parallel = [ & ] ( const std::size_t tasks_, auto && f_ ) {
+        const unsigned threads = tasks_ < threads_ ? ( unsigned ) tasks_ : threads_;
+        detail::parallel_for ( threads, [ & ] ( const unsigned t_ ) {
+            for ( std::size_t i = t_; i < tasks_; i += threads ) {
+                f_ ( i );
+            }
+        } );
+    };
+    in_parallel ( blocks, [ & ] ( const std::size_t b_ ) {
+        shuffle ( data_ + first ( b_ ), first ( b_ + 1 ) - first ( b_ ), gens [ b_ ].gen );
+    } );
+    for ( std::size_t s = 1; s < blocks; s *= 2 ) {
+        in_parallel ( blocks / ( 2 * s ), [ & ] ( const std::size_t i_ ) {
+            const std::size_t b = 2 * s * i_;
+            detail::merge_shuffled ( data_ + first ( b ), first ( b + s ) - first ( b ), first ( b + 2 * s ) - first ( b ), gens [ b ].gen );
+        } );
+    }
+}
+
+template<typename Container, typename Gen>
+void shuffle ( Container & c_, Gen & gen_, const unsigned threads_ ) {
+    shuffle ( std::data ( c_ ), std::size ( c_ ), gen_, threads_ );
+}
+
+// Writes k_ distinct indices out of [ 0, n_ ), k_ <= n_, in increasing
+// order, to out_, every subset is equally likely. T is std::uint32_t or
+// std::uint64_t.
+//
+// Vitter's method D ("An Efficient Algorithm for Sequential Random
+// Sampling", 1987), the distance to the next index is drawn directly,
+// O ( k_ ) time, no memory. For dense samples (13 k_ >= n_, the rest of)
+// the indices are taken with method A, one compare per skipped index.
+template<typename Gen, typename T>
+void sample ( Gen & gen_, const T n_, T * out_, std::size_t k_ ) noexcept {
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+    static_assert ( std::is_same<T, std::uint32_t>::value || std::is_same<T, std::uint64_t>::value, "T should be std::uint32_t or std::uint64_t" );
+    const auto uniform = [ & ] ( ) noexcept { return detail::to_open_unit_double ( detail::draw64 ( gen_ ) ); };
+    std::uint64_t n = n_, i = 0; // Records left, the next record.
+    if ( k_ > 1 && 13 * ( std::uint64_t ) k_ < n ) {
+        double kinv = 1.0 / k_, v = std::exp ( std::log ( uniform ( ) ) * kinv );
+        std::uint64_t q = n - k_ + 1;
+        while ( k_ > 1 && 13 * ( std::uint64_t ) k_ < n ) {
+            const double k1inv = 1.0 / ( k_ - 1 );
+            std::uint64_t s;
+            for ( ;; ) {
+                double x;
+                do {
+                    x = n * ( 1.0 - v );
+                    s = ( std::uint64_t ) x;
+                    if ( s >= q ) {
+                        v = std::exp ( std::log ( uniform ( ) ) * kinv );
+                    }
+                } while ( s >= q );
+                const double y1 = std::exp ( std::log ( uniform ( ) * n / q ) * k1inv );
+                v = y1 * ( 1.0 - x / n ) * ( q / ( double ) ( q - s ) );
+                if ( v <= 1.0 ) {
+                    break;
+                }
+                // The exact test.
+                double y2 = 1.0, top = n - 1.0, bottom;
+                std::uint64_t limit;
+                if ( k_ - 1 > s ) {
+                    bottom = ( double ) ( n - k_ );
+                    limit  = n - s;
+                }
+                else {
+                    bottom = ( double ) ( n - s - 1 );
+                    limit  = q;
+                }
+                for ( std::uint64_t t = n - 1; t >= limit; --t, top -= 1.0, bottom -= 1.0 ) {
+                    y2 = y2 * top / bottom;
+                }
+                if ( n / ( n - x ) >= y1 * std::exp ( std::log ( y2 ) * k1inv ) ) {
+                    v = std::exp ( std::log ( uniform ( ) ) * k1inv );
+                    break;
+                }
+                v = std::exp ( std::log ( uniform ( ) ) * kinv );
+            }
+            i += s;
+            *out_++ = ( T ) i++;
+            n -= s + 1;
+            q -= s;
+            --k_;
+            kinv = k1inv;
+        }
+        if ( k_ == 1 ) {
+            *out_ = ( T ) ( i + ( std::uint64_t ) ( n * v ) );
+            return;
+        }
+    }
+    double top = ( double ) ( n - k_ ), left = ( double ) n;
+    for ( ; k_ > 1; --k_ ) {
+        const double v = uniform ( );
+        double quot = top / left;
+        while ( quot > v ) {
+            ++i;
+            top -= 1.0;
+            left -= 1.0;
+            quot = quot * top / left;
+        }
+        *out_++ = ( T ) i++;
+        left -= 1.0;
+    }
+    if ( k_ ) {
+        *out_ = ( T ) ( i + ( std::uint64_t ) ( left * uniform ( ) ) );
+    }
+}
+
+template<typename Gen, typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, std::uint32_t>::value || std::is_same<typename Container::value_type, std::uint64_t>::value>>
+void sample ( Gen & gen_, const typename Container::value_type n_, Container & c_ ) noexcept {
+    sample ( gen_, n_, std::data ( c_ ), std::size ( c_ ) );
+}
+
+// A uniform random sample of k items (without replacement) from a stream
+// of unknown length.
+//
+// Li's algorithm L ("Reservoir-Sampling Algorithms of Time Complexity
+// O ( n ( 1 + log ( N / n ) ) )", 1994), once the reservoir is full, the
+// number of items until the next replacement is drawn from a geometric
+// distribution, O ( k ( 1 + log ( N / k ) ) ) draws for N items. skip ( )
+// tells how many items will be passed over, push ( data, n ) jumps over
+// those.
+template<typename T, typename Gen>
+class reservoir_sampler {
+
+    static_assert ( detail::is_full_range_generator<Gen> ( ), "Gen should return full range 32- or 64-bit words" );
+
+    double uniform ( ) noexcept {
+        return detail::to_open_unit_double ( detail::draw64 ( m_gen ) );
+    }
+
+    // Draws the position of the next item to be taken.
+    void advance ( ) noexcept {
+        m_w *= std::exp ( std::log ( uniform ( ) ) / m_k );
+        const double s = std::floor ( std::log ( uniform ( ) ) / std::log1p ( -m_w ) );
+        m_next = s < 0x1.0p63 ? m_next + ( std::uint64_t ) s + 1 : std::numeric_limits<std::uint64_t>::max ( );
+    }
+
+    void replace ( const T & item_ ) {
+        m_samples [ ( std::size_t ) bounded ( m_gen, m_k ) ] = item_;
+        advance ( );
+    }
+
+    public:
+
+    using value_type     = T;
+    using generator_type = Gen;
+
+    // Keeps k_ > 0 items, drawing from (a copy of) gen_.
+    reservoir_sampler ( const std::size_t k_, const Gen & gen_ ) : m_gen { gen_ }, m_k { k_ } {
+        assert ( k_ > 0 );
+        m_samples.reserve ( k_ );
+    }
+
+    void push ( const T & item_ ) {
+        if ( m_count < m_k ) {
+            m_samples.push_back ( item_ );
+            if ( ++m_count == m_k ) {
+                m_next = m_count - 1;
+                advance ( );
+            }
+            return;
+        }
+        if ( m_count++ == m_next ) {
+            replace ( item_ );
+        }
+    }
+
+    // Only the items that are taken are read.
+    void push ( const T * data_, std::size_t n_ ) {
+        for ( ; n_ && m_count < m_k; --n_ ) {
+            push ( *data_++ );
+        }
+        while ( n_ ) {
+            const std::uint64_t s = m_next - m_count;
+            if ( s >= n_ ) {
+                m_count += n_;
+                return;
+            }
+            data_ += s;
+            n_ -= s + 1;
+            m_count += s + 1;
+            replace ( *data_++ );
+        }
+    }
+
+    // The number of items that will be passed over before the next one is
+    // taken.
+    std::uint64_t skip ( ) const noexcept {
+        return m_count < m_k ? 0 : m_next - m_count;
+    }
+
+    // Skips n_ items, n_ <= skip ( ).
+    void discard ( const std::uint64_t n_ ) noexcept {
+        m_count += n_;
+    }
+
+    const std::vector<T> & samples ( ) const noexcept {
+        return m_samples;
+    }
+
+    // The number of items pushed (or discarded).
+    std::uint64_t count ( ) const noexcept {
+        return m_count;
+    }
+
+    std::size_t capacity ( ) const noexcept {
+        return m_k;
+    }
+
+    private:
+
+    Gen m_gen;
+    std::size_t m_k;
+    std::vector<T> m_samples;
+    std::uint64_t m_count = 0, m_next = 0;
+    double m_w = 1.0;
+};
+} // namespace iu
@@ -0,0 +1,592 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <immintrin.h>
+#include <cstdint>
+#include <cstring>
+
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include <sax/splitmix.hpp>
+
+#include "integer_utils.hpp"
+#include "xoroshiro_jump.hpp"
+#include "xoroshiro_meo.hpp"
+
+namespace iu {
+
+namespace detail {
+
+// Lane-wise operations on the words (of Bits bits) of a vector V. The
+// AVX2 versions emulate what the ISA lacks: 8-bit shifts (16-bit shifts
+// and a mask), 8-bit and 64-bit multiplies (16-bit, 32-bit multiplies).
+template<typename V, int Bits>
+struct simd_ops;
+
+template<int Bits>
+struct simd_ops<__m256i, Bits> {
+
+    using vec = __m256i;
+
+    static vec loadu ( const void * p_ ) noexcept {
+        return _mm256_loadu_si256 ( reinterpret_cast<const __m256i *> ( p_ ) );
+    }
+    static void storeu ( void * p_, const vec v_ ) noexcept {
+        _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( p_ ), v_ );
+    }
+
+    // Stores the low halves of the words, the result is half a vector.
+    static void storeu_narrow ( void * p_, const vec v_ ) noexcept {
+        __m256i v;
+        if constexpr ( Bits == 64 ) {
+            v = _mm256_permutevar8x32_epi32 ( v_, _mm256_setr_epi32 ( 0, 2, 4, 6, 1, 3, 5, 7 ) );
+        }
+        else {
+            const __m256i s = Bits == 32 ? _mm256_setr_epi8 ( 0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, 0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1 )
+                                         : _mm256_setr_epi8 ( 0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1, 0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1 );
+            v = _mm256_permute4x64_epi64 ( _mm256_shuffle_epi8 ( v_, s ), _MM_SHUFFLE ( 3, 1, 2, 0 ) );
+        }
+        _mm_storeu_si128 ( reinterpret_cast<__m128i *> ( p_ ), _mm256_castsi256_si128 ( v ) );
+    }
+
+    static vec zero ( ) noexcept {
+        return _mm256_setzero_si256 ( );
+    }
+
+    static vec bit_xor ( const vec a_, const vec b_ ) noexcept {
+        return _mm256_xor_si256 ( a_, b_ );
+    }
+    static vec bit_xor ( const vec a_, const vec b_, const vec c_ ) noexcept {
+        return _mm256_xor_si256 ( _mm256_xor_si256 ( a_, b_ ), c_ );
+    }
+
+    static vec add ( const vec a_, const vec b_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm256_add_epi64 ( a_, b_ );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm256_add_epi32 ( a_, b_ );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm256_add_epi16 ( a_, b_ );
+        }
+        else {
+            return _mm256_add_epi8 ( a_, b_ );
+        }
+    }
+
+    template<int K>
+    static vec shl ( const vec a_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm256_slli_epi64 ( a_, K );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm256_slli_epi32 ( a_, K );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm256_slli_epi16 ( a_, K );
+        }
+        else {
+            return _mm256_and_si256 ( _mm256_slli_epi16 ( a_, K ), _mm256_set1_epi8 ( ( char ) ( 0xFF << K ) ) );
+        }
+    }
+
+    template<int K>
+    static vec shr ( const vec a_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm256_srli_epi64 ( a_, K );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm256_srli_epi32 ( a_, K );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm256_srli_epi16 ( a_, K );
+        }
+        else {
+            return _mm256_and_si256 ( _mm256_srli_epi16 ( a_, K ), _mm256_set1_epi8 ( ( char ) ( 0xFF >> K ) ) );
+        }
+    }
+
+    template<int K>
+    static vec rotl ( const vec a_ ) noexcept {
+        return _mm256_or_si256 ( shl<K> ( a_ ), shr<Bits - K> ( a_ ) );
+    }
+
+    // The low Bits bits of a_ * m_.
+    static vec mul ( const vec a_, const std::uint64_t m_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            const __m256i m = _mm256_set1_epi64x ( ( long long ) m_ );
+            const __m256i c = _mm256_add_epi64 ( _mm256_mul_epu32 ( _mm256_srli_epi64 ( a_, 32 ), m ), _mm256_mul_epu32 ( a_, _mm256_srli_epi64 ( m, 32 ) ) );
+            return _mm256_add_epi64 ( _mm256_mul_epu32 ( a_, m ), _mm256_slli_epi64 ( c, 32 ) );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm256_mullo_epi32 ( a_, _mm256_set1_epi32 ( ( int ) m_ ) );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm256_mullo_epi16 ( a_, _mm256_set1_epi16 ( ( short ) m_ ) );
+        }
+        else {
+            const __m256i m = _mm256_set1_epi16 ( ( short ) ( m_ & 0xFF ) ), lo = _mm256_set1_epi16 ( 0x00FF );
+            return _mm256_or_si256 ( _mm256_and_si256 ( _mm256_mullo_epi16 ( a_, m ), lo ), _mm256_slli_epi16 ( _mm256_mullo_epi16 ( _mm256_srli_epi16 ( a_, 8 ), m ), 8 ) );
+        }
+    }
+};
+
+#if defined ( __AVX512F__ )
+template<int Bits>
+struct simd_ops<__m512i, Bits> {
+
+    using vec = __m512i;
+
+    static vec loadu ( const void * p_ ) noexcept {
+        return _mm512_loadu_si512 ( p_ );
+    }
+    static void storeu ( void * p_, const vec v_ ) noexcept {
+        _mm512_storeu_si512 ( p_, v_ );
+    }
+
+    // Stores the low halves of the words, the result is half a vector.
+    static void storeu_narrow ( void * p_, const vec v_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( p_ ), _mm512_cvtepi64_epi32 ( v_ ) );
+        }
+        else if constexpr ( Bits == 32 ) {
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( p_ ), _mm512_cvtepi32_epi16 ( v_ ) );
+        }
+        else {
+            _mm256_storeu_si256 ( reinterpret_cast<__m256i *> ( p_ ), _mm512_cvtepi16_epi8 ( v_ ) );
+        }
+    }
+
+    static vec zero ( ) noexcept {
+        return _mm512_setzero_si512 ( );
+    }
+
+    static vec bit_xor ( const vec a_, const vec b_ ) noexcept {
+        return _mm512_xor_si512 ( a_, b_ );
+    }
+    static vec bit_xor ( const vec a_, const vec b_, const vec c_ ) noexcept {
+        return _mm512_ternarylogic_epi64 ( a_, b_, c_, 0x96 ); // a ^ b ^ c
+    }
+
+    static vec add ( const vec a_, const vec b_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm512_add_epi64 ( a_, b_ );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm512_add_epi32 ( a_, b_ );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm512_add_epi16 ( a_, b_ );
+        }
+        else {
+            return _mm512_add_epi8 ( a_, b_ );
+        }
+    }
+
+    template<int K>
+    static vec shl ( const vec a_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm512_slli_epi64 ( a_, K );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm512_slli_epi32 ( a_, K );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm512_slli_epi16 ( a_, K );
+        }
+        else {
+            return _mm512_and_si512 ( _mm512_slli_epi16 ( a_, K ), _mm512_set1_epi8 ( ( char ) ( 0xFF << K ) ) );
+        }
+    }
+
+    template<int K>
+    static vec shr ( const vec a_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm512_srli_epi64 ( a_, K );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm512_srli_epi32 ( a_, K );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm512_srli_epi16 ( a_, K );
+        }
+        else {
+            return _mm512_and_si512 ( _mm512_srli_epi16 ( a_, K ), _mm512_set1_epi8 ( ( char ) ( 0xFF >> K ) ) );
+        }
+    }
+
+    template<int K>
+    static vec rotl ( const vec a_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+            return _mm512_rol_epi64 ( a_, K );
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm512_rol_epi32 ( a_, K );
+        }
+        else {
+            return _mm512_or_si512 ( shl<K> ( a_ ), shr<Bits - K> ( a_ ) );
+        }
+    }
+
+    // The low Bits bits of a_ * m_.
+    static vec mul ( const vec a_, const std::uint64_t m_ ) noexcept {
+        if constexpr ( Bits == 64 ) {
+#if defined ( __AVX512DQ__ )
+            return _mm512_mullo_epi64 ( a_, _mm512_set1_epi64 ( ( long long ) m_ ) );
+#else
+            const __m512i m = _mm512_set1_epi64 ( ( long long ) m_ );
+            const __m512i c = _mm512_add_epi64 ( _mm512_mul_epu32 ( _mm512_srli_epi64 ( a_, 32 ), m ), _mm512_mul_epu32 ( a_, _mm512_srli_epi64 ( m, 32 ) ) );
+            return _mm512_add_epi64 ( _mm512_mul_epu32 ( a_, m ), _mm512_slli_epi64 ( c, 32 ) );
+#endif
+        }
+        else if constexpr ( Bits == 32 ) {
+            return _mm512_mullo_epi32 ( a_, _mm512_set1_epi32 ( ( int ) m_ ) );
+        }
+        else if constexpr ( Bits == 16 ) {
+            return _mm512_mullo_epi16 ( a_, _mm512_set1_epi16 ( ( short ) m_ ) );
+        }
+        else {
+            const __m512i m = _mm512_set1_epi16 ( ( short ) ( m_ & 0xFF ) ), lo = _mm512_set1_epi16 ( 0x00FF );
+            return _mm512_or_si512 ( _mm512_and_si512 ( _mm512_mullo_epi16 ( a_, m ), lo ), _mm512_slli_epi16 ( _mm512_mullo_epi16 ( _mm512_srli_epi16 ( a_, 8 ), m ), 8 ) );
+        }
+    }
+};
+#endif
+
+// The widest vector for words of type I: __m512i with AVX-512F (and BW
+// for 8 and 16-bit words), __m256i otherwise.
+template<typename I>
+#if defined ( __AVX512BW__ )
+using simd_xoroshiro_vec = __m512i;
+#elif defined ( __AVX512F__ )
+using simd_xoroshiro_vec = std::conditional_t<( sizeof ( I ) >= 4 ), __m512i, __m256i>;
+#else
+using simd_xoroshiro_vec = __m256i;
+#endif
+
+template<typename I, typename R, unsigned A, unsigned B, unsigned C>
+struct simd_xoroshiro_params {
+
+    static_assert ( sizeof ( I ) <= 8, "the state words are at most 64 bits" );
+    static_assert ( sizeof ( R ) == sizeof ( I ) || 2 * sizeof ( R ) == sizeof ( I ), "the output is the state word or its upper half" );
+
+    using itype = I;
+    using rtype = R;
+    using vec   = simd_xoroshiro_vec<I>;
+    using ops   = simd_ops<vec, 8 * sizeof ( I )>;
+
+    static constexpr int a = A, b = B, c = C;
+};
+
+// The parameters of the meo::xoroshiro_detail generators, and their
+// output functions on vectors.
+template<typename Gen>
+struct simd_xoroshiro_traits;
+
+template<typename I, typename R, unsigned A, unsigned B, unsigned C>
+struct simd_xoroshiro_traits<meo::xoroshiro_detail::xoroshiro_plus<I, R, A, B, C>> : simd_xoroshiro_params<I, R, A, B, C> {
+    using typename simd_xoroshiro_params<I, R, A, B, C>::ops;
+    using typename simd_xoroshiro_params<I, R, A, B, C>::vec;
+    static vec output ( const vec s0_, const vec s1_ ) noexcept {
+        return ops::add ( s0_, s1_ );
+    }
+};
+
+template<typename I, typename R, unsigned A, unsigned B, unsigned C, I M>
+struct simd_xoroshiro_traits<meo::xoroshiro_detail::xoroshiro_star<I, R, A, B, C, M>> : simd_xoroshiro_params<I, R, A, B, C> {
+    using typename simd_xoroshiro_params<I, R, A, B, C>::ops;
+    using typename simd_xoroshiro_params<I, R, A, B, C>::vec;
+    static vec output ( const vec s0_, const vec ) noexcept {
+        return ops::mul ( s0_, M );
+    }
+};
+
+template<typename I, typename R, unsigned A, unsigned B, unsigned C, I M1, unsigned Rot, I M2>
+struct simd_xoroshiro_traits<meo::xoroshiro_detail::xoroshiro_starstar<I, R, A, B, C, M1, Rot, M2>> : simd_xoroshiro_params<I, R, A, B, C> {
+    using typename simd_xoroshiro_params<I, R, A, B, C>::ops;
+    using typename simd_xoroshiro_params<I, R, A, B, C>::vec;
+    static vec output ( const vec s0_, const vec ) noexcept {
+        return ops::mul ( ops::template rotl<Rot> ( ops::mul ( s0_, M1 ) ), M2 );
+    }
+};
+
+// Reads the (protected) state of a meo generator.
+template<typename Gen>
+struct xoroshiro_state : Gen {
+    explicit xoroshiro_state ( const Gen & g_ ) noexcept : Gen ( g_ ) { }
+    auto s0 ( ) const noexcept {
+        return this->s0_;
+    }
+    auto s1 ( ) const noexcept {
+        return this->s1_;
+    }
+};
+} // namespace detail
+
+// Lanes copies of a meo::xoroshiro_detail generator (plus, star or
+// starstar, with up to 64-bit state words) in the lanes of AVX2 or
+// AVX-512 vectors, e.g. xoroshiro64starstar32 as 16 lanes of 32-bit words
+// in a __m512i, xoroshiro32plus16 as 32 lanes of 16-bit words. Lane i is
+// the stream of lane 0 jumped ahead i times (Gen::jump ( ), 2^(N/2) steps
+// for N bits of state), so the lanes don't overlap, lane 0 is the stream
+// of the scalar generator seeded the same way.
+//
+// Lanes defaults to one vector, a multiple of that runs as many
+// independent vectors per step, which hides the latency of the step. The
+// values come out step by step, lane by lane, generate ( ) writes the
+// same values as as many calls to operator ( ).
+template<typename Gen, std::size_t Lanes = sizeof ( typename detail::simd_xoroshiro_traits<Gen>::vec ) / sizeof ( typename detail::simd_xoroshiro_traits<Gen>::itype )>
+class simd_xoroshiro {
+
+    using traits = detail::simd_xoroshiro_traits<Gen>;
+    using itype  = typename traits::itype;
+    using vec    = typename traits::vec;
+    using ops    = typename traits::ops;
+
+    static constexpr int word_bits            = 8 * sizeof ( itype );
+    static constexpr std::size_t state_bits   = 2 * word_bits;
+    static constexpr std::size_t vector_lanes = sizeof ( vec ) / sizeof ( itype );
+    static constexpr std::size_t vectors      = Lanes / vector_lanes;
+    static constexpr bool narrow              = sizeof ( typename traits::rtype ) < sizeof ( itype );
+
+    static_assert ( Lanes && Lanes % vector_lanes == 0, "Lanes should be a multiple of the number of words in a vector" );
+
+    using poly = detail::gf2_poly<state_bits>;
+
+    static void advance ( itype & s0_, itype & s1_ ) noexcept {
+        s1_ ^= s0_;
+        s0_ = itype ( itype ( s0_ << traits::a | s0_ >> ( word_bits - traits::a ) ) ^ s1_ ^ itype ( s1_ << traits::b ) );
+        s1_ = itype ( s1_ << traits::c | s1_ >> ( word_bits - traits::c ) );
+    }
+
+    static const detail::gf2_char_poly<state_bits> & char_poly ( ) noexcept {
+        static const detail::gf2_char_poly<state_bits> p ( [ s0 = itype ( 0xc1f651c67c62c6e0 ), s1 = itype ( 0x30d89576f866ac9f ) ] ( ) mutable {
+            const bool r = s0 & 1;
+            advance ( s0, s1 );
+            return r;
+        } );
+        return p;
+    }
+
+    static void jump ( itype & s0_, itype & s1_, const poly & j_ ) noexcept {
+        itype s0 = 0, s1 = 0;
+        for ( std::size_t i = 0; i < state_bits; ++i ) {
+            if ( j_.coefficient ( i ) ) {
+                s0 ^= s0_;
+                s1 ^= s1_;
+            }
+            advance ( s0_, s1_ );
+        }
+        s0_ = s0;
+        s1_ = s1;
+    }
+
+    static void step ( vec & s0_, vec & s1_, typename traits::rtype * out_ ) noexcept {
+        const vec r = traits::output ( s0_, s1_ );
+        if constexpr ( narrow ) {
+            ops::storeu_narrow ( out_, ops::template shr<word_bits / 2> ( r ) );
+        }
+        else {
+            ops::storeu ( out_, r );
+        }
+        const vec s1 = ops::bit_xor ( s1_, s0_ );
+        s0_          = ops::bit_xor ( ops::template rotl<traits::a> ( s0_ ), s1, ops::template shl<traits::b> ( s1 ) );
+        s1_          = ops::template rotl<traits::c> ( s1 );
+    }
+
+    // The values of the next step (of all lanes) to out_, the state
+    // advances. Unrolled, so the vectors stay in registers.
+    template<std::size_t... V>
+    static void step ( vec * s0_, vec * s1_, typename traits::rtype * out_, std::index_sequence<V...> ) noexcept {
+        ( step ( s0_ [ V ], s1_ [ V ], out_ + V * vector_lanes ), ... );
+    }
+
+    static void step ( vec * s0_, vec * s1_, typename traits::rtype * out_ ) noexcept {
+        step ( s0_, s1_, out_, std::make_index_sequence<vectors> { } );
+    }
+
+    public:
+
+    using result_type = typename traits::rtype;
+
+    static constexpr result_type min ( ) noexcept {
+        return std::numeric_limits<result_type>::min ( );
+    }
+
+    static constexpr result_type max ( ) noexcept {
+        return std::numeric_limits<result_type>::max ( );
+    }
+
+    static constexpr std::size_t lanes ( ) noexcept {
+        return Lanes;
+    }
+
+    // System seeded by default.
+    simd_xoroshiro ( ) noexcept {
+        std::uint64_t s [ 2 ];
+        iu::seed ( s, 2 );
+        seed ( Gen ( ( itype ) s [ 0 ], ( itype ) s [ 1 ] ) );
+    }
+
+    explicit simd_xoroshiro ( const std::uint64_t s_ ) noexcept {
+        seed ( s_ );
+    }
+
+    // Lane 0 continues g_.
+    explicit simd_xoroshiro ( const Gen & g_ ) noexcept {
+        seed ( g_ );
+    }
+
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    explicit simd_xoroshiro ( Sseq & q_ ) {
+        seed ( q_ );
+    }
+
+    void seed ( const std::uint64_t s_ ) noexcept {
+        sax::splitmix64 rng ( s_ );
+        const itype s0 = ( itype ) rng ( );
+        seed ( Gen ( s0, ( itype ) rng ( ) ) );
+    }
+
+    void seed ( const Gen & g_ ) noexcept {
+        static const poly j = char_poly ( ).pow2 ( state_bits / 2 );
+        const detail::xoroshiro_state<Gen> g ( g_ );
+        itype s0 = g.s0 ( ), s1 = g.s1 ( );
+        for ( std::size_t i = 0; i < Lanes; ++i ) {
+            m_s0 [ i ] = s0;
+            m_s1 [ i ] = s1;
+            jump ( s0, s1, j );
+        }
+        m_i = Lanes;
+    }
+
+    template<typename Sseq, typename = std::enable_if_t<detail::is_seed_seq<Sseq>::value>>
+    void seed ( Sseq & q_ ) {
+        seed ( Gen ( q_ ) );
+    }
+
+    result_type operator ( ) ( ) noexcept {
+        if ( m_i == Lanes ) {
+            refill ( );
+        }
+        return m_r [ m_i++ ];
+    }
+
+    void generate ( result_type * out_, std::size_t n_ ) noexcept {
+        // Drain the values left over from the last operator ( ) or generate ( ).
+        for ( ; m_i < Lanes && n_; --n_ ) {
+            *out_++ = m_r [ m_i++ ];
+        }
+        if ( !n_ ) {
+            return;
+        }
+        vec s0 [ vectors ], s1 [ vectors ];
+        load ( s0, s1 );
+        for ( std::size_t v = n_ / Lanes; v; --v, out_ += Lanes ) {
+            step ( s0, s1, out_ );
+        }
+        // The tail, the rest of the last step is kept for operator ( ).
+        if ( n_ % Lanes ) {
+            step ( s0, s1, m_r );
+            std::memcpy ( out_, m_r, ( n_ % Lanes ) * sizeof ( result_type ) );
+            m_i = n_ % Lanes;
+        }
+        store ( s0, s1 );
+    }
+
+    template<typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, result_type>::value>>
+    void generate ( Container & c_ ) noexcept {
+        generate ( std::data ( c_ ), std::size ( c_ ) );
+    }
+
+    // Jumps every lane ahead Lanes * 2^(N/2) steps, past the streams of the
+    // other lanes, copies jumped 0, 1, 2, ... times don't overlap. The
+    // values still buffered are dropped.
+    void jump ( ) noexcept {
+        static const poly j = jump_poly ( );
+        // All lanes at once, the coefficients are the same for every lane.
+        vec s0 [ vectors ], s1 [ vectors ], j0 [ vectors ], j1 [ vectors ];
+        for ( std::size_t v = 0; v < vectors; ++v ) {
+            j0 [ v ] = j1 [ v ] = ops::zero ( );
+        }
+        result_type r [ Lanes ];
+        load ( s0, s1 );
+        for ( std::size_t i = 0; i < state_bits; ++i ) {
+            if ( j.coefficient ( i ) ) {
+                for ( std::size_t v = 0; v < vectors; ++v ) {
+                    j0 [ v ] = ops::bit_xor ( j0 [ v ], s0 [ v ] );
+                    j1 [ v ] = ops::bit_xor ( j1 [ v ], s1 [ v ] );
+                }
+            }
+            step ( s0, s1, r );
+        }
+        store ( j0, j1 );
+        m_i = Lanes;
+    }
+
+    private:
+
+    // x^(Lanes * 2^(N/2)) mod P.
+    static poly jump_poly ( ) noexcept {
+        if constexpr ( state_bits / 2 == 64 ) {
+            return char_poly ( ).pow ( Lanes, 0 );
+        }
+        else {
+            return char_poly ( ).pow ( 0, std::uint64_t { Lanes } << ( state_bits / 2 ) );
+        }
+    }
+
+    void refill ( ) noexcept {
+        vec s0 [ vectors ], s1 [ vectors ];
+        load ( s0, s1 );
+        step ( s0, s1, m_r );
+        store ( s0, s1 );
+        m_i = 0;
+    }
+
+    void load ( vec * s0_, vec * s1_ ) const noexcept {
+        for ( std::size_t v = 0; v < vectors; ++v ) {
+            s0_ [ v ] = ops::loadu ( m_s0 + v * vector_lanes );
+            s1_ [ v ] = ops::loadu ( m_s1 + v * vector_lanes );
+        }
+    }
+
+    void store ( const vec * s0_, const vec * s1_ ) noexcept {
+        for ( std::size_t v = 0; v < vectors; ++v ) {
+            ops::storeu ( m_s0 + v * vector_lanes, s0_ [ v ] );
+            ops::storeu ( m_s1 + v * vector_lanes, s1_ [ v ] );
+        }
+    }
+
+    alignas ( 64 ) itype m_s0 [ Lanes ], m_s1 [ Lanes ];
+    alignas ( 64 ) result_type m_r [ Lanes ];
+    std::size_t m_i = Lanes;
+};
+} // namespace iu
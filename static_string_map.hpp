@@ -0,0 +1,242 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "integer_utils.hpp"
+
+namespace iu {
+
+namespace detail {
+
+// Little-endian read of N bytes, written out so the optimizer combines
+// it into a single load.
+template<std::size_t... I>
+constexpr std::uint64_t mph_read ( const char * p_, std::index_sequence<I...> ) noexcept {
+    return ( ( std::uint64_t { static_cast<std::uint8_t> ( p_ [ I ] ) } << ( 8 * I ) ) | ... );
+}
+
+template<std::size_t N>
+constexpr std::uint64_t mph_read ( const char * p_ ) noexcept {
+    return mph_read ( p_, std::make_index_sequence<N> { } );
+}
+
+// Constexpr string hash for short keys, the first and last 8 bytes are
+// read directly, only keys longer than 16 bytes loop.
+constexpr std::uint64_t mph_hash ( const std::string_view s_, std::uint64_t h_ ) noexcept {
+    const char * p = s_.data ( );
+    std::size_t n  = s_.size ( );
+    std::uint64_t a = 0, b = 0;
+    if ( n >= 8 ) {
+        for ( ; n > 16; n -= 8, p += 8 ) {
+            h_ = ( h_ ^ mph_read<8> ( p ) ) * 0xFF51AFD7ED558CCD;
+            h_ ^= h_ >> 32;
+        }
+        a = mph_read<8> ( p );
+        b = mph_read<8> ( p + n - 8 );
+    }
+    else if ( n >= 4 ) {
+        a = mph_read<4> ( p );
+        b = mph_read<4> ( p + n - 4 );
+    }
+    else if ( n ) {
+        a = ( mph_read<1> ( p ) << 16 ) | ( mph_read<1> ( p + n / 2 ) << 8 ) | mph_read<1> ( p + n - 1 );
+    }
+    h_ = ( h_ ^ a ^ ( std::uint64_t { s_.size ( ) } << 56 ) ) * 0x9E3779B97F4A7C15 + b;
+    h_ = ( h_ ^ ( h_ >> 29 ) ) * 0xC4CEB9FE1A85EC53;
+    return h_ ^ ( h_ >> 32 );
+}
+
+// Maps x_ uniformly on [ 0, n_ ), without a division.
+constexpr std::size_t mph_range ( const std::uint64_t x_, const std::size_t n_ ) noexcept {
+    return ( std::size_t ) ( ( ( x_ & 0xFFFF'FFFF ) * n_ ) >> 32 );
+}
+
+constexpr std::size_t mph_slot ( const std::uint64_t h_, const std::int32_t d_, const std::size_t n_ ) noexcept {
+    return mph_range ( ( ( h_ ^ ( std::uint64_t ( d_ ) * 0x9E3779B97F4A7C15 ) ) * 0xD6E8FEB86659FD93 ) >> 32, n_ );
+}
+} // namespace detail
+
+// Immutable string -> V map over a fixed key set, with a minimal perfect
+// hash (hash and displace) built at compile time.
+//
+// The keys are hashed once into buckets (about 2 keys per bucket). The
+// buckets are placed largest first, for every bucket the displacement
+// that maps all of its keys to free slots is searched for, the keys of
+// singleton buckets are put directly in the remaining free slots. A
+// lookup is one string hash, one read of the displacement table, one
+// slot computation and one key compare.
+//
+//     constexpr auto keywords = iu::make_static_string_map<int> ( { { "GET", 1 }, { "PUT", 2 }, { "DELETE", 3 } } );
+//     static_assert ( *keywords.find ( "PUT" ) == 2 );
+//
+// The keys should be distinct, the string_views refer to the key strings,
+// use string literals.
+template<typename V, std::size_t N>
+class static_string_map {
+
+    static_assert ( N > 0, "the key set should not be empty" );
+
+    static constexpr std::size_t bucket_count = N > 1 ? N / 2 : 1;
+
+    public:
+
+    using key_type    = std::string_view;
+    using mapped_type = V;
+    using value_type  = std::pair<std::string_view, V>;
+
+    constexpr static_string_map ( const value_type ( &kv_ ) [ N ] ) noexcept {
+        for ( std::uint64_t seed = 0x0CF3FD1B9997F637;; seed = fmix64 ( seed + 1 ) ) {
+            if ( build ( kv_, seed ) ) {
+                break;
+            }
+        }
+    }
+
+    constexpr const V * find ( const std::string_view key_ ) const noexcept {
+        const std::uint64_t h  = detail::mph_hash ( key_, m_seed );
+        const std::int32_t d   = m_displacement [ detail::mph_range ( h >> 32, bucket_count ) ];
+        const std::size_t slot = d < 0 ? std::size_t ( -d - 1 ) : detail::mph_slot ( h, d, N );
+        return m_keys [ slot ] == key_ ? m_values + slot : nullptr;
+    }
+
+    constexpr bool contains ( const std::string_view key_ ) const noexcept {
+        return find ( key_ ) != nullptr;
+    }
+
+    constexpr V value_or ( const std::string_view key_, const V default_ ) const noexcept {
+        const V * v = find ( key_ );
+        return v ? *v : default_;
+    }
+
+    static constexpr std::size_t size ( ) noexcept {
+        return N;
+    }
+
+    // The keys and values, in slot order.
+    constexpr const std::string_view & key ( const std::size_t i_ ) const noexcept {
+        return m_keys [ i_ ];
+    }
+    constexpr const V & value ( const std::size_t i_ ) const noexcept {
+        return m_values [ i_ ];
+    }
+
+    private:
+
+    constexpr bool build ( const value_type ( &kv_ ) [ N ], const std::uint64_t seed_ ) noexcept {
+        std::uint64_t h [ N ] = { };
+        std::size_t bucket [ N ] = { }, size [ bucket_count ] = { }, start [ bucket_count + 1 ] = { }, member [ N ] = { };
+        for ( std::size_t i = 0; i < N; ++i ) {
+            h [ i ]      = detail::mph_hash ( kv_ [ i ].first, seed_ );
+            bucket [ i ] = detail::mph_range ( h [ i ] >> 32, bucket_count );
+            ++size [ bucket [ i ] ];
+        }
+        // Group the keys by bucket.
+        for ( std::size_t b = 0; b < bucket_count; ++b ) {
+            start [ b + 1 ] = start [ b ] + size [ b ];
+        }
+        {
+            std::size_t fill [ bucket_count ] = { };
+            for ( std::size_t i = 0; i < N; ++i ) {
+                member [ start [ bucket [ i ] ] + fill [ bucket [ i ] ]++ ] = i;
+            }
+        }
+        // Order the buckets by size, largest first (counting sort).
+        std::size_t max_size = 0;
+        for ( std::size_t b = 0; b < bucket_count; ++b ) {
+            max_size = size [ b ] > max_size ? size [ b ] : max_size;
+        }
+        std::size_t order [ bucket_count ] = { }, o = 0;
+        for ( std::size_t s = max_size; s > 1; --s ) {
+            for ( std::size_t b = 0; b < bucket_count; ++b ) {
+                if ( size [ b ] == s ) {
+                    order [ o++ ] = b;
+                }
+            }
+        }
+        bool taken [ N ] = { };
+        std::int32_t displacement [ bucket_count ] = { };
+        for ( std::size_t k = 0; k < o; ++k ) {
+            const std::size_t b = order [ k ], * m = member + start [ b ];
+            std::int32_t d = 0;
+            for ( ; d < 0x1'0000; ++d ) {
+                bool fits = true;
+                for ( std::size_t i = 0; fits && i < size [ b ]; ++i ) {
+                    const std::size_t s = detail::mph_slot ( h [ m [ i ] ], d, N );
+                    fits = !taken [ s ];
+                    for ( std::size_t j = 0; fits && j < i; ++j ) {
+                        fits = s != detail::mph_slot ( h [ m [ j ] ], d, N );
+                    }
+                }
+                if ( fits ) {
+                    break;
+                }
+            }
+            if ( d == 0x1'0000 ) {
+                return false;
+            }
+            displacement [ b ] = d;
+            for ( std::size_t i = 0; i < size [ b ]; ++i ) {
+                const std::size_t s = detail::mph_slot ( h [ m [ i ] ], d, N );
+                taken [ s ]    = true;
+                m_keys [ s ]   = kv_ [ m [ i ] ].first;
+                m_values [ s ] = kv_ [ m [ i ] ].second;
+            }
+        }
+        // Singletons go straight into the remaining free slots.
+        std::size_t f = 0;
+        for ( std::size_t b = 0; b < bucket_count; ++b ) {
+            if ( size [ b ] == 1 ) {
+                while ( taken [ f ] ) {
+                    ++f;
+                }
+                taken [ f ]        = true;
+                displacement [ b ] = -std::int32_t ( f ) - 1;
+                m_keys [ f ]       = kv_ [ member [ start [ b ] ] ].first;
+                m_values [ f ]     = kv_ [ member [ start [ b ] ] ].second;
+            }
+        }
+        for ( std::size_t b = 0; b < bucket_count; ++b ) {
+            m_displacement [ b ] = displacement [ b ];
+        }
+        m_seed = seed_;
+        return true;
+    }
+
+    std::uint64_t m_seed = 0;
+    std::int32_t m_displacement [ bucket_count ] = { };
+    std::string_view m_keys [ N ] = { };
+    V m_values [ N ] = { };
+};
+
+template<typename V, std::size_t N>
+constexpr static_string_map<V, N> make_static_string_map ( const std::pair<std::string_view, V> ( &kv_ ) [ N ] ) noexcept {
+    return static_string_map<V, N> ( kv_ );
+}
+} // namespace iu
@@ -0,0 +1,225 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sax/splitmix.hpp>
+
+#include "random.hpp"
+
+namespace iu {
+
+namespace detail {
+
+template<typename Gen, typename = void>
+struct has_jump : std::false_type { };
+template<typename Gen>
+struct has_jump<Gen, std::void_t<decltype ( std::declval<Gen &> ( ).jump ( ) )>> : std::true_type { };
+
+template<typename Gen, typename = void>
+struct has_discard : std::false_type { };
+template<typename Gen>
+struct has_discard<Gen, std::void_t<decltype ( std::declval<Gen &> ( ).discard ( std::uint64_t { }, std::uint64_t { } ) )>> : std::true_type { };
+
+template<typename Gen, typename = void>
+struct has_seed : std::false_type { };
+template<typename Gen>
+struct has_seed<Gen, std::void_t<decltype ( std::declval<Gen &> ( ).seed ( std::uint64_t { } ) )>> : std::true_type { };
+
+// A generator seeded from a 64-bit seed. The iu generators seed themselves
+// (through splitmix64), the meo generators take their two state words.
+template<typename Gen>
+Gen make_generator ( const std::uint64_t seed_ ) noexcept {
+    if constexpr ( has_seed<Gen>::value || !std::is_constructible<Gen, std::uint64_t, std::uint64_t>::value ) {
+        return Gen ( seed_ );
+    }
+    else {
+        sax::splitmix64 rng ( seed_ );
+        const std::uint64_t s0 = rng ( );
+        return Gen ( s0, rng ( ) );
+    }
+}
+
+template<typename F>
+void parallel_for ( const unsigned threads_, F && f_ ) {
+    std::vector<std::thread> pool;
+    for ( unsigned t = 1; t < threads_; ++t ) {
+        pool.emplace_back ( f_, t );
+    }
+    f_ ( 0u );
+    for ( auto & t : pool ) {
+        t.join ( );
+    }
+}
+} // namespace detail
+
+// A fixed number of independent streams of Gen, from a single seed.
+//
+// Stream i is stream 0 jumped ahead i times (for the xoroshiro's 2^(N/2)
+// steps each, the streams don't overlap), generators without jump ( )
+// are seeded from a splitmix64 sequence of seeds. Each generator has a
+// cache line (or more) to itself, handing them to different threads
+// doesn't lead to false sharing.
+//
+// pool [ task_id ] gives results that don't depend on the number of
+// threads or the scheduling, local ( ) hands every thread the next unused
+// stream (the first time it is called on that thread), which is not
+// reproducible, but needs no task id.
+template<typename Gen>
+class stream_pool {
+
+    struct alignas ( 64 ) padded_generator {
+        Gen gen;
+    };
+
+    static std::uint64_t next_id ( ) noexcept {
+        static std::atomic<std::uint64_t> id { 0 };
+        return ++id;
+    }
+
+    public:
+
+    using generator_type = Gen;
+    using result_type    = typename Gen::result_type;
+
+    stream_pool ( const std::uint64_t seed_, const std::size_t streams_ ) : m_id { next_id ( ) } {
+        m_streams.reserve ( streams_ );
+        if constexpr ( detail::has_jump<Gen>::value ) {
+            Gen gen = detail::make_generator<Gen> ( seed_ );
+            for ( std::size_t i = 0; i < streams_; ++i ) {
+                m_streams.push_back ( { gen } );
+                gen.jump ( );
+            }
+        }
+        else {
+            sax::splitmix64 rng ( seed_ );
+            for ( std::size_t i = 0; i < streams_; ++i ) {
+                m_streams.push_back ( { detail::make_generator<Gen> ( rng ( ) ) } );
+            }
+        }
+    }
+
+    stream_pool ( const stream_pool & ) = delete;
+    stream_pool & operator = ( const stream_pool & ) = delete;
+
+    Gen & operator [ ] ( const std::size_t i_ ) noexcept {
+        return m_streams [ i_ ].gen;
+    }
+
+    // The stream of the calling thread, claimed on its first call on this
+    // pool (a thread keeps its stream of every pool it uses). Throws
+    // std::length_error if there are more threads than streams.
+    Gen & local ( ) {
+        // By pool id, ids are never reused.
+        thread_local std::vector<std::pair<std::uint64_t, Gen *>> claimed;
+        for ( const auto & c : claimed ) {
+            if ( c.first == m_id ) {
+                return *c.second;
+            }
+        }
+        const std::size_t i = m_claimed.fetch_add ( 1, std::memory_order_relaxed );
+        if ( i >= m_streams.size ( ) ) {
+            throw std::length_error ( "iu::stream_pool::local ( ): more threads than streams" );
+        }
+        claimed.emplace_back ( m_id, &m_streams [ i ].gen );
+        return *claimed.back ( ).second;
+    }
+
+    std::size_t size ( ) const noexcept {
+        return m_streams.size ( );
+    }
+
+    private:
+
+    std::vector<padded_generator> m_streams;
+    const std::uint64_t m_id;
+    std::atomic<std::size_t> m_claimed { 0 };
+};
+
+// The block size of fill ( ) for generators that can't discard ( ).
+constexpr std::size_t fill_block_size = std::size_t { 1 } << 16;
+
+// Fills out_ [ 0, n_ ) from gen_ with threads_ threads, the values don't
+// depend on the number of threads.
+//
+// If Gen can discard ( ), the values are those of n_ calls to gen_ ( ),
+// every thread starts from a copy of gen_ discarded up to its range, gen_
+// is left n_ values on. Otherwise out_ is cut in blocks of fill_block_size
+// values, block b is filled by gen_ jumped b times, and gen_ is left
+// jumped once for every block.
+template<typename Gen>
+void fill ( Gen & gen_, typename Gen::result_type * out_, const std::size_t n_, unsigned threads_ ) {
+    static_assert ( detail::has_discard<Gen>::value || detail::has_jump<Gen>::value, "Gen should have discard ( ) or jump ( )" );
+    threads_ = threads_ ? threads_ : 1;
+    if constexpr ( detail::has_discard<Gen>::value ) {
+        // Ranges of whole cache lines, for a 64-byte aligned out_ no two
+        // threads write to the same line.
+        const std::size_t line = 64 / sizeof ( typename Gen::result_type ), chunk = ( ( n_ + threads_ - 1 ) / threads_ + line - 1 ) / line * line;
+        detail::parallel_for ( threads_, [ & ] ( const unsigned t_ ) {
+            const std::size_t b = t_ * chunk < n_ ? t_ * chunk : n_, e = b + chunk < n_ ? b + chunk : n_;
+            if ( b < e ) {
+                Gen gen = gen_;
+                gen.discard ( 0, b );
+                detail::generate ( gen, out_ + b, e - b );
+            }
+        } );
+        gen_.discard ( 0, n_ );
+    }
+    else {
+        const std::size_t blocks = ( n_ + fill_block_size - 1 ) / fill_block_size, chunk = ( blocks + threads_ - 1 ) / threads_;
+        detail::parallel_for ( threads_, [ & ] ( const unsigned t_ ) {
+            const std::size_t b = t_ * chunk < blocks ? t_ * chunk : blocks, e = b + chunk < blocks ? b + chunk : blocks;
+            if ( b < e ) {
+                Gen gen = gen_;
+                for ( std::size_t i = 0; i < b; ++i ) {
+                    gen.jump ( );
+                }
+                for ( std::size_t i = b; i < e; ++i ) {
+                    Gen block = gen;
+                    const std::size_t o = i * fill_block_size;
+                    detail::generate ( block, out_ + o, n_ - o < fill_block_size ? n_ - o : fill_block_size );
+                    gen.jump ( );
+                }
+            }
+        } );
+        for ( std::size_t i = 0; i < blocks; ++i ) {
+            gen_.jump ( );
+        }
+    }
+}
+
+template<typename Gen, typename Container, typename = std::enable_if_t<std::is_same<typename Container::value_type, typename Gen::result_type>::value>>
+void fill ( Gen & gen_, Container & c_, const unsigned threads_ ) {
+    fill ( gen_, std::data ( c_ ), std::size ( c_ ), threads_ );
+}
+} // namespace iu
@@ -0,0 +1,125 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vector>
+
+#include "../blocked_bloom.hpp"
+#include "../cuckoo_filter.hpp"
+#include "../integer_utils.hpp"
+
+// Test of blocked_bloom and cuckoo_filter.
+//
+// test_filters [ n ]
+//
+// The cuckoo filter, sized for n (default 2^20) keys, is filled with
+// random keys until it is full, once by insert ( ) and once by
+// insert_many ( ), both should stop at the same key, and report every key
+// up to and including that one as present (the victim slot holds the
+// fingerprint kicked out last). A full filter should refuse further keys
+// and take them again once keys are erased. The Bloom filter should have
+// no false negatives, and a false positive rate near the expected one.
+
+namespace {
+
+int failures = 0;
+
+void check ( const bool ok_, const char * what_ ) {
+    if ( !ok_ ) {
+        std::printf ( "  FAIL %s\n", what_ );
+        ++failures;
+    }
+}
+
+std::vector<std::uint64_t> random_keys ( const std::size_t n_, const std::uint64_t seed_ ) {
+    std::vector<std::uint64_t> keys ( n_ );
+    sax::splitmix64 rng ( seed_ );
+    for ( auto & k : keys ) {
+        k = rng ( );
+    }
+    return keys;
+}
+
+std::size_t count_present ( const iu::cuckoo_filter & f_, const std::uint64_t * keys_, const std::size_t n_ ) {
+    std::size_t c = 0;
+    for ( std::size_t i = 0; i < n_; ++i ) {
+        c += f_.contains ( keys_ [ i ] );
+    }
+    return c;
+}
+
+void test_cuckoo ( const std::size_t n_ ) {
+    iu::cuckoo_filter a ( n_ ), b ( n_ );
+    // More keys than slots, the filter fills up before they run out.
+    const std::vector<std::uint64_t> keys = random_keys ( a.capacity ( ) + 1, 0x5C3B'4A1E'9D27'F6C1 );
+
+    std::size_t k = 0;
+    while ( k < keys.size ( ) && a.insert ( keys [ k ] ) ) {
+        ++k;
+    }
+    std::printf ( "cuckoo_filter, %zu slots, full after %zu keys (load %.4f)\n", a.capacity ( ), k + 1, ( double ) ( k + 1 ) / a.capacity ( ) );
+    check ( k < keys.size ( ), "the filter never filled up" );
+    check ( a.size ( ) == k + 1, "insert ( ), size ( ) after the filter is full" );
+    check ( count_present ( a, keys.data ( ), k + 1 ) == k + 1, "insert ( ), false negatives in a full filter" );
+    check ( !a.insert ( keys [ 0 ] ^ 1 ) && a.size ( ) == k + 1, "insert ( ) into a full filter" );
+
+    const std::size_t r = b.insert_many ( keys.data ( ), keys.size ( ) );
+    check ( r == k + 1, "insert_many ( ) and insert ( ) stop at different keys" );
+    check ( b.size ( ) == r, "insert_many ( ), size ( ) after the filter is full" );
+    std::vector<std::uint8_t> present ( r );
+    check ( b.contains_many ( keys.data ( ), r, present.data ( ) ) == r, "insert_many ( ), false negatives in a full filter" );
+    check ( b.insert_many ( keys.data ( ) + r, keys.size ( ) - r ) == 0, "insert_many ( ) into a full filter" );
+
+    // Erasing a tenth of the keys makes room for the victim, and new keys.
+    for ( std::size_t i = 0; i < r / 10; ++i ) {
+        check ( b.erase ( keys [ i ] ), "erase ( ) of an inserted key" );
+    }
+    check ( b.size ( ) == r - r / 10, "size ( ) after erase ( )" );
+    check ( count_present ( b, keys.data ( ) + r / 10, r - r / 10 ) == r - r / 10, "false negatives after erase ( )" );
+    const std::vector<std::uint64_t> more = random_keys ( r / 20, 0x2E81'D7A0'63B9'C54F );
+    check ( b.insert_many ( more.data ( ), more.size ( ) ) == more.size ( ), "insert_many ( ) after erase ( )" );
+    check ( count_present ( b, more.data ( ), more.size ( ) ) == more.size ( ), "false negatives after re-filling" );
+}
+
+void test_bloom ( const std::size_t n_ ) {
+    iu::blocked_bloom f ( n_ );
+    const std::vector<std::uint64_t> keys = random_keys ( n_, 0x9B1F'06D4'E83A'725C ), others = random_keys ( n_, 0x47C2'A95E'1B60'3FD8 );
+    f.insert_many ( keys.data ( ), keys.size ( ) );
+    std::vector<std::uint8_t> present ( n_ );
+    check ( f.contains_many ( keys.data ( ), n_, present.data ( ) ) == n_, "blocked_bloom, false negatives" );
+    const double fpr = ( double ) f.contains_many ( others.data ( ), n_, present.data ( ) ) / n_;
+    std::printf ( "blocked_bloom, 10 bits per key, false positive rate %.4f\n", fpr );
+    check ( fpr < 0.02, "blocked_bloom, false positive rate at 10 bits per key" );
+}
+} // namespace
+
+auto main ( int argc, char ** argv ) -> int {
+    const std::size_t n = argc > 1 ? ( std::size_t ) std::strtoull ( argv [ 1 ], nullptr, 0 ) : std::size_t { 1 } << 20;
+    test_cuckoo ( n );
+    test_bloom ( n );
+    std::printf ( "%s, %d failures\n", failures ? "FAILED" : "passed", failures );
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vector>
+
+#include "../hyperloglog.hpp"
+#include "../integer_utils.hpp"
+
+// Test of hyperloglog.
+//
+// For a range of counts (sparse and dense sketches), at P = 4 and 14: a
+// sketch of all keys and the merge of the sketches of two halves should
+// give the same estimate (if both are sparse or both dense), merging a sketch with itself should change
+// nothing, and the estimate should be within 5 standard errors of the
+// count.
+
+namespace {
+
+int failures = 0;
+
+void check ( const bool ok_, const char * what_, const int p_, const std::size_t n_ ) {
+    if ( !ok_ ) {
+        std::printf ( "  FAIL %s, P = %d, n = %zu\n", what_, p_, n_ );
+        ++failures;
+    }
+}
+
+template<int P>
+void test ( const std::size_t n_ ) {
+    std::vector<std::uint64_t> keys ( n_ );
+    sax::splitmix64 rng ( 0x6A09'E667'F3BC'C908 + n_ );
+    for ( auto & k : keys ) {
+        k = rng ( );
+    }
+    iu::hyperloglog<P> all, lo, hi;
+    all.add_many ( keys.data ( ), n_ );
+    lo.add_many ( keys.data ( ), n_ / 2 );
+    for ( std::size_t i = n_ / 2; i < n_; ++i ) {
+        hi.add ( keys [ i ] );
+    }
+    const double e = all.estimate ( );
+
+    // A sparse sketch turns dense when its buffer is flushed, when that
+    // happens depends on the order of the adds and merges, the estimates
+    // of the two representations differ.
+    iu::hyperloglog<P> merged = lo;
+    merged |= hi;
+    check ( merged.is_sparse ( ) != all.is_sparse ( ) || merged.estimate ( ) == e, "merge of the halves", P, n_ );
+    hi |= lo;
+    check ( hi.is_sparse ( ) != all.is_sparse ( ) || hi.estimate ( ) == e, "merge of the halves, the other way around", P, n_ );
+
+    const bool sparse = all.is_sparse ( );
+    all |= all;
+    check ( all.is_sparse ( ) == sparse && all.estimate ( ) == e, "merge with itself", P, n_ );
+
+    const double se = 1.04 / std::sqrt ( double ( std::size_t { 1 } << P ) );
+    check ( std::abs ( e - double ( n_ ) ) <= 5.0 * se * double ( n_ ) + 1.0, "estimate", P, n_ );
+    std::printf ( "P = %2d, n = %8zu, %s, estimate %10.1f, error %+.4f\n", P, n_, sparse ? "sparse" : "dense ", e, n_ ? ( e - double ( n_ ) ) / double ( n_ ) : 0.0 );
+}
+} // namespace
+
+auto main ( ) -> int {
+    for ( const std::size_t n : { 0, 1, 10, 100, 1000, 3000, 10000, 100000, 1000000 } ) {
+        test<4> ( n );
+        test<14> ( n );
+    }
+    std::printf ( "%s, %d failures\n", failures ? "FAILED" : "passed", failures );
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,267 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vector>
+
+#include "../integer_utils.hpp"
+#include "../simd_xoroshiro.hpp"
+#include "../xoroshiro_meo.hpp"
+
+// Test of the jumps (xoroshiro_jump.hpp).
+//
+// For every meo generator, discard ( k ) should equal k calls, for k on
+// both sides of the state size (the characteristic polynomial is only
+// used above it), and jump ( ) / long_jump ( ) should equal discard (
+// 2^(N/2) ) / discard ( 2^(3N/4) ). The jumps of xoroshiro128 (24, 16, 37)
+// and iu::xoroshiro128plus64 should equal the reference jump with the
+// published constants. Lane i of iu::simd_xoroshiro and of
+// iu::xoroshiro8x128plusavx512 should be the scalar generator jumped i
+// times, also after a jump ( ) of the vector generator.
+
+namespace {
+
+int failures = 0;
+
+void check ( const bool ok_, const char * name_, const char * what_ ) {
+    if ( !ok_ ) {
+        std::printf ( "  FAIL %s, %s\n", name_, what_ );
+        ++failures;
+    }
+}
+
+// Blackman and Vigna's xoroshiro128 (24, 16, 37) jump ( ), 2^64 steps, and
+// long_jump ( ), 2^96 steps.
+constexpr std::uint64_t reference_jump [ 2 ]      = { 0xDF900294D8F554A5, 0x170865DF4B3201FC };
+constexpr std::uint64_t reference_long_jump [ 2 ] = { 0xD2A98B26625EEE7B, 0xDDDF9B1090AA7AC1 };
+
+void reference_jump_128 ( std::uint64_t & s0_, std::uint64_t & s1_, const std::uint64_t ( & j_ ) [ 2 ] ) noexcept {
+    std::uint64_t s0 = 0, s1 = 0;
+    for ( const std::uint64_t j : j_ ) {
+        for ( int b = 0; b < 64; ++b ) {
+            if ( j & std::uint64_t { 1 } << b ) {
+                s0 ^= s0_;
+                s1 ^= s1_;
+            }
+            meo::xoroshiro128plus64::advance ( s0_, s1_ );
+        }
+    }
+    s0_ = s0;
+    s1_ = s1;
+}
+
+template<typename Gen>
+Gen make ( ) {
+    using itype = decltype ( iu::detail::xoroshiro_state<Gen> ( Gen ( ) ).s0 ( ) );
+    sax::splitmix64 rng ( 0x243F'6A88'85A3'08D3 );
+    const itype s0 = ( itype ) rng ( );
+    return Gen ( s0, ( itype ) rng ( ) );
+}
+
+template<typename Gen>
+bool same ( Gen a_, Gen b_ ) {
+    return a_ == b_;
+}
+
+template<typename Gen>
+void test_meo ( const char * name_ ) {
+    using itype          = decltype ( iu::detail::xoroshiro_state<Gen> ( Gen ( ) ).s0 ( ) );
+    constexpr int bits   = 8 * sizeof ( itype ); // N / 2.
+    constexpr int n      = 2 * bits;
+    const Gen g          = make<Gen> ( );
+    for ( const std::uint64_t k : { 0, 1, 2, n - 1, n, n + 1, 3 * n + 7, 1000, 65537 } ) {
+        Gen a = g, b = g;
+        a.discard ( 0, k );
+        for ( std::uint64_t i = 0; i < k; ++i ) {
+            b ( );
+        }
+        check ( same ( a, b ), name_, "discard ( k ) and k calls" );
+    }
+    Gen a = g, b = g;
+    a.jump ( );
+    if constexpr ( bits < 64 ) {
+        b.discard ( 0, std::uint64_t { 1 } << bits );
+    }
+    else if constexpr ( bits < 128 ) {
+        b.discard ( std::uint64_t { 1 } << ( bits - 64 ), 0 );
+    }
+    else {
+        // 2^128 doesn't fit, twice 2^127.
+        b.discard ( std::uint64_t { 1 } << 63, 0 );
+        b.discard ( std::uint64_t { 1 } << 63, 0 );
+    }
+    check ( same ( a, b ), name_, "jump ( ) and discard ( 2^(N/2) )" );
+    if constexpr ( 3 * n / 4 < 128 ) {
+        a = g;
+        b = g;
+        a.long_jump ( );
+        if constexpr ( 3 * n / 4 < 64 ) {
+            b.discard ( 0, std::uint64_t { 1 } << ( 3 * n / 4 ) );
+        }
+        else {
+            b.discard ( std::uint64_t { 1 } << ( 3 * n / 4 - 64 ), 0 );
+        }
+        check ( same ( a, b ), name_, "long_jump ( ) and discard ( 2^(3N/4) )" );
+    }
+    std::printf ( "%-28s discard ( ), jump ( ), long_jump ( )\n", name_ );
+}
+
+template<typename Gen>
+void test_reference ( const char * name_ ) {
+    const Gen g = make<Gen> ( );
+    const iu::detail::xoroshiro_state<Gen> s ( g );
+    std::uint64_t s0 = s.s0 ( ), s1 = s.s1 ( );
+    reference_jump_128 ( s0, s1, reference_jump );
+    Gen a = g;
+    a.jump ( );
+    check ( same ( a, Gen ( s0, s1 ) ), name_, "jump ( ) and the reference jump" );
+    s0 = s.s0 ( );
+    s1 = s.s1 ( );
+    reference_jump_128 ( s0, s1, reference_long_jump );
+    a = g;
+    a.long_jump ( );
+    check ( same ( a, Gen ( s0, s1 ) ), name_, "long_jump ( ) and the reference long jump" );
+    std::printf ( "%-28s jump ( ), long_jump ( ) against the reference\n", name_ );
+}
+
+// iu::xoroshiro128plus64 and meo::xoroshiro128plus64, seeded the same,
+// should give the same values, jumped or not.
+void test_iu_xoroshiro ( ) {
+    const char * name = "iu::xoroshiro128plus64";
+    constexpr std::uint64_t seed = 0x1319'8A2E'0370'7344;
+    sax::splitmix64 rng ( seed );
+    const std::uint64_t s0 = rng ( );
+    const meo::xoroshiro128plus64 m ( s0, rng ( ) );
+    for ( int j = 0; j < 3; ++j ) {
+        iu::xoroshiro128plus64 a ( seed );
+        meo::xoroshiro128plus64 b = m;
+        if ( j == 1 ) {
+            a.jump ( );
+            b.jump ( );
+        }
+        else if ( j == 2 ) {
+            a.long_jump ( );
+            b.long_jump ( );
+        }
+        bool ok = true;
+        for ( int i = 0; i < 16; ++i ) {
+            ok = ok && a ( ) == b ( );
+        }
+        check ( ok, name, j == 0 ? "the values of meo::xoroshiro128plus64" : j == 1 ? "jump ( ) and meo::xoroshiro128plus64::jump ( )" : "long_jump ( ) and meo::xoroshiro128plus64::long_jump ( )" );
+    }
+    std::printf ( "%-28s jump ( ), long_jump ( ) against meo\n", name );
+}
+
+// Lane i of v_ against the scalar generators c_ [ i ], for steps_ steps.
+template<typename V, typename Gen>
+bool lanes_match ( V & v_, std::vector<Gen> & c_, const std::size_t steps_ ) {
+    const std::size_t lanes = c_.size ( );
+    bool ok = true;
+    for ( std::size_t t = 0; t < steps_; ++t ) {
+        for ( std::size_t i = 0; i < lanes; ++i ) {
+            ok = ok && v_ ( ) == c_ [ i ] ( );
+        }
+    }
+    return ok;
+}
+
+// Vectors_ vectors of lanes (of AVX2 or AVX-512, as compiled).
+template<typename Gen, std::size_t Vectors>
+void test_simd ( const char * name_ ) {
+    constexpr std::size_t Lanes = Vectors * iu::simd_xoroshiro<Gen>::lanes ( );
+    const Gen g = make<Gen> ( );
+    iu::simd_xoroshiro<Gen, Lanes> v ( g );
+    std::vector<Gen> c ( Lanes, g );
+    for ( std::size_t i = 0; i < Lanes; ++i ) {
+        for ( std::size_t j = 0; j < i; ++j ) {
+            c [ i ].jump ( );
+        }
+    }
+    check ( lanes_match ( v, c, 64 ), name_, "lane i and the scalar generator jumped i times" );
+    // Every lane moves Lanes jumps ahead.
+    v.jump ( );
+    for ( auto & s : c ) {
+        for ( std::size_t j = 0; j < Lanes; ++j ) {
+            s.jump ( );
+        }
+    }
+    check ( lanes_match ( v, c, 64 ), name_, "lane i after jump ( )" );
+    std::printf ( "%-28s %zu lanes against scalar jumps\n", name_, Lanes );
+}
+
+void test_8x ( ) {
+    const char * name = "iu::xoroshiro8x128plusavx512";
+    if ( !iu::xoroshiro8x128plusavx512::is_supported ( ) ) {
+        std::printf ( "%-28s skipped, no AVX-512\n", name );
+        return;
+    }
+    constexpr std::uint64_t seed = 0xA409'3822'299F'31D0;
+    sax::splitmix64 rng ( seed );
+    const std::uint64_t s0 = rng ( );
+    std::vector<meo::xoroshiro128plus64> c ( 8, meo::xoroshiro128plus64 ( s0, rng ( ) ) );
+    for ( std::size_t i = 0; i < 8; ++i ) {
+        for ( std::size_t j = 0; j < i; ++j ) {
+            c [ i ].jump ( );
+        }
+    }
+    iu::xoroshiro8x128plusavx512 v ( seed );
+    check ( lanes_match ( v, c, 64 ), name, "lane i and the scalar generator jumped i times" );
+    v.jump ( );
+    for ( auto & s : c ) {
+        s.discard ( 8, 0 );
+    }
+    check ( lanes_match ( v, c, 64 ), name, "lane i after jump ( )" );
+    std::printf ( "%-28s 8 lanes against scalar jumps\n", name );
+}
+} // namespace
+
+auto main ( ) -> int {
+    test_meo<meo::xoroshiro128plus64v0_1> ( "xoroshiro128plus64v0_1" );
+    test_meo<meo::xoroshiro128plus64> ( "xoroshiro128plus64" );
+    test_meo<meo::xoroshiro128starstar64> ( "xoroshiro128starstar64" );
+    test_meo<meo::xoroshiro128plus32> ( "xoroshiro128plus32" );
+    test_meo<meo::xoroshiro256plus64> ( "xoroshiro256plus64" );
+    test_meo<meo::xoroshiro64plus32vMEO1> ( "xoroshiro64plus32vMEO1" );
+    test_meo<meo::xoroshiro64plus32> ( "xoroshiro64plus32" );
+    test_meo<meo::xoroshiro64starstar32> ( "xoroshiro64starstar32" );
+    test_meo<meo::xoroshiro32plus16> ( "xoroshiro32plus16" );
+    test_meo<meo::xoroshiro16plus8> ( "xoroshiro16plus8" );
+
+    test_reference<meo::xoroshiro128plus64> ( "xoroshiro128plus64" );
+    test_reference<meo::xoroshiro128starstar64> ( "xoroshiro128starstar64" );
+    test_iu_xoroshiro ( );
+
+    test_simd<meo::xoroshiro128plus64, 1> ( "simd xoroshiro128plus64" );
+    test_simd<meo::xoroshiro128plus64, 2> ( "simd xoroshiro128plus64" );
+    test_simd<meo::xoroshiro128starstar64, 1> ( "simd xoroshiro128starstar64" );
+    test_simd<meo::xoroshiro128plus32, 1> ( "simd xoroshiro128plus32" );
+    test_simd<meo::xoroshiro64starstar32, 2> ( "simd xoroshiro64starstar32" );
+    test_simd<meo::xoroshiro32plus16, 1> ( "simd xoroshiro32plus16" );
+    test_8x ( );
+
+    std::printf ( "%s, %d failures\n", failures ? "FAILED" : "passed", failures );
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,480 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../integer_utils.hpp"
+
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// With MSVC mulmod64.h defines mulmod64 (a function pointer) at namespace
+// scope, so does integer_utils.cpp, internal linkage avoids the clash.
+namespace {
+#include "../sprp32.h"
+#include "../sprp32_sf.h"
+#include "../sprp64.h"
+#include "../sprp64_sf.h"
+} // namespace
+
+// Differential test and benchmark of the Miller-Rabin tests of the
+// library: straightforward_mr32/64 (sprp*_sf.h, % and mulmod64) vs
+// efficient_mr32/64 (sprp*.h, Montgomery) vs iu::is_prime ( ).
+//
+// test_sprp [ -t threads ] [ -r lo hi ] [ -n count ] [ -s seed ] [ -b ]
+//
+//   -t threads  the default is all cores.
+//   -r lo hi    the 32-bit range of the exhaustive test, the default is
+//               all of [ 3, 2^32 ).
+//   -n count    random 64-bit values, the default is 2^22.
+//   -s seed     of the random values.
+//   -b          only the benchmark.
+//
+// 32 bits: every odd n in the range, the sprp test of every base of
+// is_prime ( ) (2, 7, 61), both implementations, should agree, all bases
+// should agree with a (segmented) sieve, is_prime ( ) as well. The
+// strong pseudoprimes found go to the 64-bit tests.
+//
+// 64 bits: the same per base agreement, for the 7 bases of is_prime ( )
+// (Sinclair's) and the 12 primes up to 37, with a reference (trial
+// division, Miller-Rabin on the primes up to 37, deterministic below
+// 3.18 * 10^23, with 128-bit arithmetic where there is). On random odd
+// values, random primes, the 32-bit strong pseudoprimes, known strong
+// pseudoprimes to several bases, Carmichael numbers (Chernick's ( 6k + 1 )
+// ( 12k + 1 ) ( 18k + 1 ) up to 2^64), squares and products of primes
+// near 2^32 and the odd values near 2^32, 2^63 and 2^64.
+//
+// The benchmark is ns per call, on random odd values and on primes (all
+// bases run), the best of 5 runs.
+
+namespace {
+
+using u8  = std::uint8_t;
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+constexpr u32 bases32 [ 3 ] = { 2, 7, 61 };
+constexpr u64 bases64 [ 7 ] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+constexpr u64 primes64 [ 12 ] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+struct failures {
+
+    void report ( const char * what_, const u64 n_, const u64 base_ = 0 ) {
+        std::lock_guard<std::mutex> lock ( m_mutex );
+        if ( m_count++ < 20 ) {
+            if ( base_ ) {
+                std::printf ( "  FAIL %s, n = %llu, base %llu\n", what_, ( unsigned long long ) n_, ( unsigned long long ) base_ );
+            }
+            else {
+                std::printf ( "  FAIL %s, n = %llu\n", what_, ( unsigned long long ) n_ );
+            }
+        }
+    }
+
+    u64 count ( ) const noexcept {
+        return m_count;
+    }
+
+    private:
+
+    std::mutex m_mutex;
+    std::atomic<u64> m_count { 0 };
+};
+
+failures failed;
+
+// The reference.
+
+u64 mul_mod ( const u64 a_, const u64 b_, const u64 n_ ) noexcept {
+#ifdef __SIZEOF_INT128__
+    return ( u64 ) ( ( unsigned __int128 ) a_ * b_ % n_ );
+#else
+    return mulmod64 ( a_, b_, n_ );
+#endif
+}
+
+u64 pow_mod ( u64 a_, u64 e_, const u64 n_ ) noexcept {
+    u64 r = 1;
+    for ( ; e_; e_ >>= 1 ) {
+        if ( e_ & 1 ) {
+            r = mul_mod ( r, a_, n_ );
+        }
+        a_ = mul_mod ( a_, a_, n_ );
+    }
+    return r;
+}
+
+bool reference_is_prime ( const u64 n_ ) noexcept {
+    if ( n_ < 2 ) {
+        return false;
+    }
+    for ( const u64 p : primes64 ) {
+        if ( n_ % p == 0 ) {
+            return n_ == p;
+        }
+    }
+    const int t = ( int ) iu::tzCount ( n_ - 1 );
+    const u64 u = ( n_ - 1 ) >> t;
+    for ( const u64 a : primes64 ) {
+        u64 x = pow_mod ( a, u, n_ );
+        if ( x == 1 || x == n_ - 1 ) {
+            continue;
+        }
+        int i = 1;
+        for ( ; i < t; ++i ) {
+            x = mul_mod ( x, x, n_ );
+            if ( x == n_ - 1 ) {
+                break;
+            }
+        }
+        if ( i >= t ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 32 bits, exhaustive.
+
+constexpr u64 segment = u64 { 1 } << 24; // Values per segment.
+
+std::vector<u32> small_primes ( ) {
+    std::vector<bool> composite ( 1 << 16 );
+    std::vector<u32> p;
+    for ( u32 i = 3; i < ( 1 << 16 ); i += 2 ) {
+        if ( !composite [ i ] ) {
+            p.push_back ( i );
+            for ( u32 j = i * i; j < ( 1 << 16 ); j += 2 * i ) {
+                composite [ j ] = true;
+            }
+        }
+    }
+    return p;
+}
+
+// Tests the odd n in [ lo_, hi_ ), the strong pseudoprimes go to spsp_.
+void test_segment ( const u64 lo_, const u64 hi_, const std::vector<u32> & primes_, std::vector<u8> & composite_, std::vector<u64> & spsp_ ) {
+    // composite_ [ i ] for lo_ + 2 i, lo_ odd.
+    std::fill ( composite_.begin ( ), composite_.end ( ), 0 );
+    const u64 count = ( hi_ - lo_ + 1 ) / 2;
+    for ( const u64 p : primes_ ) {
+        if ( p * p >= hi_ ) {
+            break;
+        }
+        u64 m = std::max ( p * p, ( lo_ + p - 1 ) / p * p );
+        m += ( m & 1 ) ? 0 : p;
+        for ( ; m < hi_; m += 2 * p ) {
+            composite_ [ ( m - lo_ ) / 2 ] = 1;
+        }
+    }
+    for ( u64 i = 0; i < count; ++i ) {
+        const u32 n      = ( u32 ) ( lo_ + 2 * i );
+        const bool prime = !composite_ [ i ];
+        bool all         = true, any = false;
+        for ( const u32 b : bases32 ) {
+            const int e = efficient_mr32 ( &b, 1, n ), s = straightforward_mr32 ( &b, 1, n );
+            if ( e != s ) {
+                failed.report ( "efficient_mr32 != straightforward_mr32", n, b );
+            }
+            all &= e == 1;
+            if ( e && !prime && n > b ) {
+                any = true;
+            }
+        }
+        if ( all != prime ) {
+            failed.report ( "sprp32 ( 2, 7, 61 ) != sieve", n );
+        }
+        if ( iu::is_prime ( n ) != prime ) {
+            failed.report ( "iu::is_prime ( u32 ) != sieve", n );
+        }
+        if ( any ) {
+            spsp_.push_back ( n );
+        }
+    }
+}
+
+std::vector<u64> test_32 ( const u64 lo_, const u64 hi_, const unsigned threads_ ) {
+    const std::vector<u32> primes = small_primes ( );
+    const u64 segments            = ( hi_ - lo_ + segment - 1 ) / segment;
+    std::atomic<u64> next { 0 };
+    std::mutex mutex;
+    std::vector<u64> spsp;
+    std::vector<std::thread> pool;
+    for ( unsigned t = 0; t < threads_; ++t ) {
+        pool.emplace_back ( [ & ] {
+            std::vector<u8> composite ( segment / 2 );
+            std::vector<u64> found;
+            for ( u64 s; ( s = next++ ) < segments; ) {
+                const u64 lo = lo_ + s * segment;
+                test_segment ( lo, std::min ( lo + segment, hi_ ), primes, composite, found );
+            }
+            std::lock_guard<std::mutex> lock ( mutex );
+            spsp.insert ( spsp.end ( ), found.begin ( ), found.end ( ) );
+        } );
+    }
+    for ( std::thread & t : pool ) {
+        t.join ( );
+    }
+    std::sort ( spsp.begin ( ), spsp.end ( ) );
+    return spsp;
+}
+
+// 64 bits.
+
+void test_64 ( const u64 n_ ) {
+    if ( n_ < 3 || !( n_ & 1 ) ) {
+        return;
+    }
+    const bool prime = reference_is_prime ( n_ );
+    bool all         = true;
+    for ( const u64 b : bases64 ) {
+        const int e = efficient_mr64 ( &b, 1, n_ ), s = straightforward_mr64 ( &b, 1, n_ );
+        if ( e != s ) {
+            failed.report ( "efficient_mr64 != straightforward_mr64", n_, b );
+        }
+        all &= e == 1;
+    }
+    for ( const u64 b : primes64 ) {
+        const int e = efficient_mr64 ( &b, 1, n_ ), s = straightforward_mr64 ( &b, 1, n_ );
+        if ( e != s ) {
+            failed.report ( "efficient_mr64 != straightforward_mr64", n_, b );
+        }
+        if ( prime && !e ) {
+            failed.report ( "efficient_mr64 says a prime is composite", n_, b );
+        }
+    }
+    if ( all != prime ) {
+        failed.report ( "sprp64 ( Sinclair's bases ) != reference", n_ );
+    }
+    if ( iu::is_prime ( n_ ) != prime ) {
+        failed.report ( "iu::is_prime ( u64 ) != reference", n_ );
+    }
+}
+
+template<typename F>
+void parallel ( const std::vector<u64> & v_, const unsigned threads_, F f_ ) {
+    std::atomic<std::size_t> next { 0 };
+    std::vector<std::thread> pool;
+    for ( unsigned t = 0; t < threads_; ++t ) {
+        pool.emplace_back ( [ & ] {
+            for ( std::size_t i; ( i = next.fetch_add ( 4096 ) ) < v_.size ( ); ) {
+                for ( std::size_t j = i; j < std::min ( i + 4096, v_.size ( ) ); ++j ) {
+                    f_ ( v_ [ j ] );
+                }
+            }
+        } );
+    }
+    for ( std::thread & t : pool ) {
+        t.join ( );
+    }
+}
+
+// Strong pseudoprimes to several bases (the smallest to the first k
+// primes, Jaeschke, "On Strong Pseudoprimes to Several Bases", 1993, and
+// Zhang and Tang, 2003) and to the bases of is_prime ( u32 ).
+constexpr u64 known_spsp [ ] = {
+    2047, 1373653, 25326001, 3215031751, 2152302898747, 3474749660383, 341550071728321, 3825123056546413051, 4759123141, 1122004669633, 9080191,
+};
+
+std::vector<u64> adversarial ( const std::vector<u64> & spsp32_ ) {
+    std::vector<u64> v ( spsp32_ );
+    v.insert ( v.end ( ), std::begin ( known_spsp ), std::end ( known_spsp ) );
+    // Carmichael numbers, the small ones and Chernick's.
+    for ( const u64 c : { 561, 1105, 1729, 2465, 2821, 6601, 8911, 10585, 15841, 29341, 41041, 46657, 52633, 62745, 63973, 75361 } ) {
+        v.push_back ( c );
+    }
+    for ( u64 k = 1; ( 6 * k + 1 ) * ( 12 * k + 1 ) <= ~u64 { 0 } / ( 18 * k + 1 ); ++k ) {
+        if ( reference_is_prime ( 6 * k + 1 ) && reference_is_prime ( 12 * k + 1 ) && reference_is_prime ( 18 * k + 1 ) ) {
+            v.push_back ( ( 6 * k + 1 ) * ( 12 * k + 1 ) * ( 18 * k + 1 ) );
+        }
+    }
+    // Squares and products of the primes below 2^32, near 2^64.
+    std::vector<u64> p;
+    for ( u64 n = ( u64 { 1 } << 32 ) - 1; p.size ( ) < 64; n -= 2 ) {
+        if ( reference_is_prime ( n ) ) {
+            p.push_back ( n );
+        }
+    }
+    for ( const u64 a : p ) {
+        for ( const u64 b : p ) {
+            v.push_back ( a * b );
+        }
+    }
+    // Near 2^32, 2^63 and 2^64.
+    for ( u64 i = 1; i < ( 1 << 16 ); i += 2 ) {
+        v.push_back ( ( u64 { 1 } << 32 ) - i );
+        v.push_back ( ( u64 { 1 } << 32 ) + i );
+        v.push_back ( ( u64 { 1 } << 63 ) - i );
+        v.push_back ( ( u64 { 1 } << 63 ) + i );
+        v.push_back ( u64 { 0 } - i );
+    }
+    return v;
+}
+
+// Benchmark.
+
+// The sums of the runs are written here, so they can't be optimized away.
+volatile int volatile_sink = 0;
+
+template<typename F>
+double ns_per_call ( const std::vector<u64> & v_, F f_ ) {
+    double best = 1e300;
+    for ( int r = 0; r < 5; ++r ) {
+        int sum          = 0;
+        const auto start = std::chrono::steady_clock::now ( );
+        for ( const u64 n : v_ ) {
+            sum += f_ ( n );
+        }
+        best = std::min ( best, std::chrono::duration<double, std::nano> ( std::chrono::steady_clock::now ( ) - start ).count ( ) / v_.size ( ) );
+        volatile_sink = sum;
+    }
+    return best;
+}
+
+void benchmark ( sax::splitmix64 & rng_ ) {
+    std::vector<u64> odd32 ( 1 << 20 ), prime32, odd64 ( 1 << 18 ), prime64;
+    for ( u64 & n : odd32 ) {
+        n = ( u32 ) rng_ ( ) | 1;
+    }
+    while ( prime32.size ( ) < ( 1 << 18 ) ) {
+        const u64 n = ( u32 ) rng_ ( ) | 1;
+        if ( n > 61 && reference_is_prime ( n ) ) {
+            prime32.push_back ( n );
+        }
+    }
+    for ( u64 & n : odd64 ) {
+        n = rng_ ( ) | 1;
+    }
+    while ( prime64.size ( ) < ( 1 << 16 ) ) {
+        const u64 n = rng_ ( ) | 1;
+        if ( reference_is_prime ( n ) ) {
+            prime64.push_back ( n );
+        }
+    }
+    std::printf ( "benchmark, ns per call\n %-22s %12s %12s\n", "", "random odd", "primes" );
+    const auto row = [ & ] ( const char * name_, const std::vector<u64> & odd_, const std::vector<u64> & prime_, auto f_ ) {
+        std::printf ( " %-22s %12.1f %12.1f\n", name_, ns_per_call ( odd_, f_ ), ns_per_call ( prime_, f_ ) );
+    };
+    row ( "straightforward_mr32", odd32, prime32, [ ] ( const u64 n_ ) { return straightforward_mr32 ( bases32, 3, ( u32 ) n_ ); } );
+    row ( "efficient_mr32", odd32, prime32, [ ] ( const u64 n_ ) { return efficient_mr32 ( bases32, 3, ( u32 ) n_ ); } );
+    row ( "iu::is_prime ( u32 )", odd32, prime32, [ ] ( const u64 n_ ) { return ( int ) iu::is_prime ( ( u32 ) n_ ); } );
+    row ( "straightforward_mr64", odd64, prime64, [ ] ( const u64 n_ ) { return straightforward_mr64 ( bases64, 7, n_ ); } );
+    row ( "efficient_mr64", odd64, prime64, [ ] ( const u64 n_ ) { return efficient_mr64 ( bases64, 7, n_ ); } );
+    row ( "iu::is_prime ( u64 )", odd64, prime64, [ ] ( const u64 n_ ) { return ( int ) iu::is_prime ( n_ ); } );
+}
+} // namespace
+
+auto main ( int argc, char ** argv ) -> int {
+
+    unsigned threads = std::max ( 1u, std::thread::hardware_concurrency ( ) );
+    u64 lo = 3, hi = u64 { 1 } << 32, count = u64 { 1 } << 22, seed = 0x2545F4914F6CDD1D;
+    bool bench_only = false;
+
+    for ( int i = 1; i < argc; ++i ) {
+        const std::string a  = argv [ i ];
+        const bool has_value = i + 1 < argc;
+        if ( a == "-t" && has_value ) {
+            threads = std::max ( 1u, ( unsigned ) std::strtoul ( argv [ ++i ], nullptr, 10 ) );
+        }
+        else if ( a == "-r" && i + 2 < argc ) {
+            lo = std::max<u64> ( std::strtoull ( argv [ ++i ], nullptr, 0 ) | 1, 3 );
+            hi = std::min<u64> ( std::strtoull ( argv [ ++i ], nullptr, 0 ), u64 { 1 } << 32 );
+        }
+        else if ( a == "-n" && has_value ) {
+            count = std::strtoull ( argv [ ++i ], nullptr, 0 );
+        }
+        else if ( a == "-s" && has_value ) {
+            seed = std::strtoull ( argv [ ++i ], nullptr, 0 );
+        }
+        else if ( a == "-b" ) {
+            bench_only = true;
+        }
+        else {
+            std::fprintf ( stderr, "test_sprp [ -t threads ] [ -r lo hi ] [ -n count ] [ -s seed ] [ -b ]\n" );
+            return a == "-h" || a == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    sax::splitmix64 rng ( seed );
+
+    if ( !bench_only ) {
+        auto start = std::chrono::steady_clock::now ( );
+        const auto seconds = [ & ] {
+            const auto now = std::chrono::steady_clock::now ( );
+            const double s = std::chrono::duration<double> ( now - start ).count ( );
+            start          = now;
+            return s;
+        };
+
+        std::printf ( "32 bits, odd n in [ %llu, %llu ), %u threads\n", ( unsigned long long ) lo, ( unsigned long long ) hi, threads );
+        std::fflush ( stdout );
+        const std::vector<u64> spsp = lo < hi ? test_32 ( lo, hi, threads ) : std::vector<u64> { };
+        std::printf ( "  %zu strong pseudoprimes (to one of 2, 7, 61), %.1f s\n", spsp.size ( ), seconds ( ) );
+
+        std::vector<u64> v ( count );
+        for ( u64 & n : v ) {
+            n = rng ( ) | 1;
+        }
+        std::printf ( "64 bits, %llu random odd values\n", ( unsigned long long ) count );
+        std::fflush ( stdout );
+        parallel ( v, threads, test_64 );
+        std::printf ( "  %.1f s\n", seconds ( ) );
+
+        v.clear ( );
+        while ( v.size ( ) < count / 64 ) {
+            const u64 n = rng ( ) | 1;
+            if ( reference_is_prime ( n ) ) {
+                v.push_back ( n );
+            }
+        }
+        std::printf ( "64 bits, %zu random primes\n", v.size ( ) );
+        std::fflush ( stdout );
+        parallel ( v, threads, test_64 );
+        std::printf ( "  %.1f s\n", seconds ( ) );
+
+        v = adversarial ( spsp );
+        std::printf ( "64 bits, %zu adversarial values\n", v.size ( ) );
+        std::fflush ( stdout );
+        parallel ( v, threads, test_64 );
+        std::printf ( "  %.1f s\n", seconds ( ) );
+
+        std::printf ( "%s, %llu failures\n\n", failed.count ( ) ? "FAILED" : "passed", ( unsigned long long ) failed.count ( ) );
+    }
+
+    benchmark ( rng );
+
+    return failed.count ( ) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -15,8 +15,6 @@
 
 namespace fs = std::experimental::filesystem;
 
-#include <autotimer.hpp>
-
 
 #ifndef __AVX2__
 #define __AVX2__ 1
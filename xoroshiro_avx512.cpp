@@ -0,0 +1,160 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// This TU is compiled with AVX-512 enabled (/arch:AVX512, -mavx512f), only
+// call into it after xoroshiro8x128plusavx512::is_supported ( ).
+
+#include <immintrin.h>
+
+#include <cstring>
+
+#include "integer_utils.hpp"
+
+
+namespace iu {
+
+namespace {
+
+inline void xoroshiro128_next ( std::uint64_t & s0_, std::uint64_t & s1_ ) noexcept {
+    s1_ ^= s0_;
+    s0_ = ( ( s0_ << 24 ) | ( s0_ >> 40 ) ) ^ s1_ ^ ( s1_ << 16 );
+    s1_ = ( s1_ << 37 ) | ( s1_ >> 27 );
+}
+
+// The jump polynomials of xoroshiro128+ (24, 16, 37), x^(2^64) and
+// x^(2^67) mod P, see xoroshiro_jump.hpp.
+constexpr std::uint64_t jump_64 [ 2 ] = { 0xDF900294D8F554A5, 0x170865DF4B3201FC };
+constexpr std::uint64_t jump_67 [ 2 ] = { 0xB4CB6197DEA2B1FE, 0x4B4A7AA8C389701C };
+
+void xoroshiro128_jump ( std::uint64_t & s0_, std::uint64_t & s1_, const std::uint64_t ( & j_ ) [ 2 ] ) noexcept {
+    std::uint64_t s0 = 0, s1 = 0;
+    for ( const std::uint64_t j : j_ ) {
+        for ( int i = 0; i < 64; ++i ) {
+            if ( j & std::uint64_t { 1 } << i ) {
+                s0 ^= s0_;
+                s1 ^= s1_;
+            }
+            xoroshiro128_next ( s0_, s1_ );
+        }
+    }
+    s0_ = s0;
+    s1_ = s1;
+}
+
+inline __m512i xoroshiro8x_step ( __m512i & s0_, __m512i & s1_ ) noexcept {
+    const __m512i r = _mm512_add_epi64 ( s0_, s1_ );
+    s1_ = _mm512_xor_si512 ( s1_, s0_ );
+    s0_ = _mm512_ternarylogic_epi64 ( _mm512_rol_epi64 ( s0_, 24 ), s1_, _mm512_slli_epi64 ( s1_, 16 ), 0x96 ); // a ^ b ^ c
+    s1_ = _mm512_rol_epi64 ( s1_, 37 );
+    return r;
+}
+} // namespace
+
+xoroshiro8x128plusavx512::xoroshiro8x128plusavx512 ( ) noexcept {
+    std::uint64_t s [ 2 ];
+    do {
+        iu::seed ( s, 2 );
+    } while ( !( s [ 0 ] | s [ 1 ] ) );
+    seed ( s [ 0 ], s [ 1 ] );
+}
+
+xoroshiro8x128plusavx512::xoroshiro8x128plusavx512 ( const std::uint64_t s_ ) noexcept {
+    seed ( s_ );
+}
+
+void xoroshiro8x128plusavx512::seed ( const std::uint64_t s_ ) noexcept {
+    sax::splitmix64 rng ( s_ );
+    const std::uint64_t s0 = rng ( );
+    seed ( s0, rng ( ) );
+}
+
+void xoroshiro8x128plusavx512::seed ( std::uint64_t s0_, std::uint64_t s1_ ) noexcept {
+    __declspec ( align ( 64 ) ) std::uint64_t s0 [ 8 ], s1 [ 8 ];
+    for ( int i = 0; i < 8; ++i ) {
+        s0 [ i ] = s0_;
+        s1 [ i ] = s1_;
+        xoroshiro128_jump ( s0_, s1_, jump_64 );
+    }
+    m_s0 = _mm512_load_si512 ( s0 );
+    m_s1 = _mm512_load_si512 ( s1 );
+    m_i  = 8;
+}
+
+void xoroshiro8x128plusavx512::jump ( ) noexcept {
+    // All lanes at once, the coefficients are the same for every lane.
+    __m512i s0 = _mm512_setzero_si512 ( ), s1 = _mm512_setzero_si512 ( );
+    for ( const std::uint64_t j : jump_67 ) {
+        for ( int i = 0; i < 64; ++i ) {
+            if ( j & std::uint64_t { 1 } << i ) {
+                s0 = _mm512_xor_si512 ( s0, m_s0 );
+                s1 = _mm512_xor_si512 ( s1, m_s1 );
+            }
+            xoroshiro8x_step ( m_s0, m_s1 );
+        }
+    }
+    m_s0 = s0;
+    m_s1 = s1;
+    m_i  = 8;
+}
+
+typename xoroshiro8x128plusavx512::result_type xoroshiro8x128plusavx512::operator ( ) ( ) noexcept {
+    if ( m_i == 8 ) {
+        _mm512_store_si512 ( m_r, xoroshiro8x_step ( m_s0, m_s1 ) );
+        m_i = 0;
+    }
+    return m_r [ m_i++ ];
+}
+
+void xoroshiro8x128plusavx512::generate ( result_type * out_, std::size_t n_ ) noexcept {
+    // Drain the values left over from the last operator ( ) or generate ( ).
+    for ( ; m_i < 8 && n_; --n_ ) {
+        *out_++ = m_r [ m_i++ ];
+    }
+    if ( !n_ ) {
+        return;
+    }
+    __m512i s0 = m_s0, s1 = m_s1;
+    std::size_t v = n_ / 8;
+    for ( ; v >= 4; v -= 4, out_ += 32 ) {
+        const __m512i r0 = xoroshiro8x_step ( s0, s1 );
+        const __m512i r1 = xoroshiro8x_step ( s0, s1 );
+        const __m512i r2 = xoroshiro8x_step ( s0, s1 );
+        const __m512i r3 = xoroshiro8x_step ( s0, s1 );
+        _mm512_storeu_si512 ( out_ + 0, r0 );
+        _mm512_storeu_si512 ( out_ + 8, r1 );
+        _mm512_storeu_si512 ( out_ + 16, r2 );
+        _mm512_storeu_si512 ( out_ + 24, r3 );
+    }
+    for ( ; v; --v, out_ += 8 ) {
+        _mm512_storeu_si512 ( out_, xoroshiro8x_step ( s0, s1 ) );
+    }
+    // The tail, the rest of the last vector is kept for operator ( ).
+    if ( n_ % 8 ) {
+        _mm512_store_si512 ( m_r, xoroshiro8x_step ( s0, s1 ) );
+        std::memcpy ( out_, m_r, ( n_ % 8 ) * sizeof ( result_type ) );
+        m_i = n_ % 8;
+    }
+    m_s0 = s0;
+    m_s1 = s1;
+}
+} // namespace iu
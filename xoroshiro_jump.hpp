@@ -0,0 +1,189 @@
+
+// MIT License
+//
+// Copyright (c) 2018, 2019 degski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace iu {
+
+namespace detail {
+
+// Polynomials over GF(2) of degree < N, bit i of w is the coefficient of x^i.
+template<std::size_t N>
+struct gf2_poly {
+
+    static constexpr std::size_t words = ( N + 63 ) / 64;
+
+    std::uint64_t w [ words ] = { };
+
+    bool coefficient ( const std::size_t i_ ) const noexcept {
+        return ( w [ i_ / 64 ] >> ( i_ % 64 ) ) & 1;
+    }
+
+    void flip ( const std::size_t i_ ) noexcept {
+        w [ i_ / 64 ] ^= std::uint64_t { 1 } << ( i_ % 64 );
+    }
+
+    gf2_poly & operator ^= ( const gf2_poly & rhs_ ) noexcept {
+        for ( std::size_t i = 0; i < words; ++i ) {
+            w [ i ] ^= rhs_.w [ i ];
+        }
+        return *this;
+    }
+
+    // Multiplies by x^m_, the coefficients of x^N and up are dropped.
+    void shift ( const std::size_t m_ ) noexcept {
+        const std::size_t q = m_ / 64, r = m_ % 64;
+        for ( std::size_t i = words; i-- > 0; ) {
+            const std::uint64_t hi = i >= q ? w [ i - q ] : 0, lo = i > q && r ? w [ i - q - 1 ] >> ( 64 - r ) : 0;
+            w [ i ] = ( hi << r ) | lo;
+        }
+        if ( N % 64 ) {
+            w [ words - 1 ] &= ( std::uint64_t { 1 } << ( N % 64 ) ) - 1;
+        }
+    }
+};
+
+// The characteristic polynomial P of a linear (over GF(2)) generator with
+// N bits of state, and the powers x^k mod P. Jumping ahead k steps is
+// multiplying the state by T^k, by Cayley-Hamilton T^k = ( x^k mod P ) ( T ),
+// so a jump is N steps of the generator, xor-ing the states that go with
+// the non-zero coefficients of x^k mod P.
+//
+// P is found with Berlekamp-Massey from 2N output bits, bit_ ( ) returns
+// the next (lowest) output bit of the generator started from any state
+// that is not zero, if P comes out of a lower degree than N, that bit
+// doesn't see the whole state and the constructor aborts (release builds
+// included). The powers x^(2^i), i < 128, are tabled.
+template<std::size_t N>
+class gf2_char_poly {
+
+    using poly = gf2_poly<N>;
+
+    static constexpr std::size_t table_size = 128;
+
+    public:
+
+    template<typename Bit>
+    explicit gf2_char_poly ( Bit && bit_ ) noexcept {
+        std::uint8_t s [ 2 * N ];
+        for ( std::size_t i = 0; i < 2 * N; ++i ) {
+            s [ i ] = bit_ ( ) & 1;
+        }
+        // Berlekamp-Massey, c is the connection polynomial, its degree is at most N.
+        gf2_poly<N + 1> c, b, t;
+        c.flip ( 0 );
+        b.flip ( 0 );
+        std::size_t l = 0, m = 1;
+        for ( std::size_t n = 0; n < 2 * N; ++n ) {
+            bool d = s [ n ];
+            for ( std::size_t i = 1; i <= l; ++i ) {
+                d ^= c.coefficient ( i ) & s [ n - i ];
+            }
+            if ( !d ) {
+                ++m;
+                continue;
+            }
+            t = b;
+            t.shift ( m );
+            if ( 2 * l <= n ) {
+                b = c;
+                c ^= t;
+                l = n + 1 - l;
+                m = 1;
+            }
+            else {
+                c ^= t;
+                ++m;
+            }
+        }
+        if ( l != N ) {
+            // The output bit doesn't see the whole state, P and every jump
+            // derived from it would be wrong, in release builds as well.
+            std::fputs ( "iu::detail::gf2_char_poly: the degree is not N, the output bit doesn't see the whole state\n", stderr );
+            std::abort ( );
+        }
+        // P is the reciprocal of c, m_p holds P - x^N.
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( c.coefficient ( N - i ) ) {
+                m_p.flip ( i );
+            }
+        }
+        m_pow2 [ 0 ].flip ( 1 );
+        for ( std::size_t i = 1; i < table_size; ++i ) {
+            m_pow2 [ i ] = mul_mod ( m_pow2 [ i - 1 ], m_pow2 [ i - 1 ] );
+        }
+    }
+
+    // a_ * b_ mod P.
+    poly mul_mod ( poly a_, const poly & b_ ) const noexcept {
+        poly r;
+        for ( std::size_t i = 0; i < N; ++i ) {
+            if ( b_.coefficient ( i ) ) {
+                r ^= a_;
+            }
+            const bool top = a_.coefficient ( N - 1 );
+            a_.shift ( 1 );
+            if ( top ) {
+                a_ ^= m_p;
+            }
+        }
+        return r;
+    }
+
+    // x^(2^e_) mod P.
+    poly pow2 ( const std::size_t e_ ) const noexcept {
+        if ( e_ < table_size ) {
+            return m_pow2 [ e_ ];
+        }
+        poly r = m_pow2 [ table_size - 1 ];
+        for ( std::size_t i = table_size - 1; i < e_; ++i ) {
+            r = mul_mod ( r, r );
+        }
+        return r;
+    }
+
+    // x^k mod P, k = hi_ * 2^64 + lo_.
+    poly pow ( const std::uint64_t hi_, const std::uint64_t lo_ ) const noexcept {
+        poly r;
+        r.flip ( 0 );
+        for ( std::size_t i = 0; i < 64; ++i ) {
+            if ( ( lo_ >> i ) & 1 ) {
+                r = mul_mod ( r, m_pow2 [ i ] );
+            }
+            if ( ( hi_ >> i ) & 1 ) {
+                r = mul_mod ( r, m_pow2 [ 64 + i ] );
+            }
+        }
+        return r;
+    }
+
+    private:
+
+    poly m_p, m_pow2 [ table_size ];
+};
+} // namespace detail
+} // namespace iu
@@ -48,7 +48,12 @@
  */
 
 
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <utility>
+
+#include "xoroshiro_jump.hpp"
 
 namespace meo {
 
@@ -82,11 +87,75 @@ public:
             // Nothing (else) to do.
     }
 
+    // Seeding from a seed_seq (anything with generate(first, last) on
+    // 32-bit words), one word per 32 bits of state (at least one per
+    // state word).
+    template <typename SeedSeq, typename = decltype(std::declval<SeedSeq&>()
+                  .generate(std::declval<std::uint32_t*>(),
+                            std::declval<std::uint32_t*>()))>
+    explicit xoroshiro(SeedSeq& seq)
+    {
+        seed(seq);
+    }
+
+    template <typename SeedSeq, typename = decltype(std::declval<SeedSeq&>()
+                  .generate(std::declval<std::uint32_t*>(),
+                            std::declval<std::uint32_t*>()))>
+    void seed(SeedSeq& seq)
+    {
+        constexpr std::size_t WORDS = (sizeof(itype) + 3) / 4;
+        std::uint32_t w[2 * WORDS];
+        seq.generate(w, w + 2 * WORDS);
+        s0_ = from_words<WORDS>(w);
+        s1_ = from_words<WORDS>(w + WORDS);
+        if (!(s0_ || s1_))
+            s1_ = 1;
+    }
+
+    // The words, least significant first, as one itype.
+    template <std::size_t WORDS>
+    static itype from_words(const std::uint32_t* w)
+    {
+        if constexpr (WORDS == 1) {
+            return itype(w[0]);
+        } else {
+            itype x = 0;
+            for (std::size_t i = WORDS; i--; )
+                x = (x << 32) | itype(w[i]);
+            return x;
+        }
+    }
+
+    static inline void advance(itype& s0, itype& s1)
+    {
+        s1 ^= s0;
+        s0 = rotl(s0, a) ^ s1 ^ (s1 << b);
+        s1 = rotl(s1, c);
+    }
+
     void advance()
     {
-        s1_ ^= s0_;
-        s0_ = rotl(s0_, a) ^ s1_ ^ (s1_ << b);
-        s1_ = rotl(s1_, c);
+        advance(s0_, s1_);
+    }
+
+    // Bulk generation, out[i] = output(state), n times.  The state is
+    // copied to locals so the stores to out can't force it back to memory.
+    template <typename Output>
+    void generate_n(rtype* out, std::size_t n, Output output)
+    {
+        itype s0 = s0_, s1 = s1_;
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            out[i+0] = output(s0, s1); advance(s0, s1);
+            out[i+1] = output(s0, s1); advance(s0, s1);
+            out[i+2] = output(s0, s1); advance(s0, s1);
+            out[i+3] = output(s0, s1); advance(s0, s1);
+        }
+        for (; i < n; ++i) {
+            out[i] = output(s0, s1); advance(s0, s1);
+        }
+        s0_ = s0;
+        s1_ = s1;
     }
 
     bool operator==(const xoroshiro& rhs)
@@ -99,10 +168,73 @@ public:
         return !operator==(rhs);
     }
 
+    // Jump-ahead, via the characteristic polynomial (xoroshiro_jump.hpp).
+    // jump() is equivalent to 2^(N/2) calls to advance(), long_jump() to
+    // 2^(3N/4) calls, for N = 2 * ITYPE_BITS bits of state, discard(k)
+    // to k calls, k = hi * 2^64 + lo.
+
+    void jump()
+    {
+        static const poly j = char_poly().pow2(STATE_BITS / 2);
+        jump(j);
+    }
+
+    void long_jump()
+    {
+        static const poly j = char_poly().pow2(3 * STATE_BITS / 4);
+        jump(j);
+    }
+
+    void discard(std::uint64_t hi, std::uint64_t lo)
+    {
+        jump(char_poly().pow(hi, lo));
+    }
+
+#ifdef __SIZEOF_INT128__
+    void discard(unsigned __int128 k)
+    {
+        discard(std::uint64_t(k >> 64), std::uint64_t(k));
+    }
+#else
+    void discard(std::uint64_t k)
+    {
+        discard(0, k);
+    }
+#endif
+
     // Not (yet) implemented:
-    //   - arbitrary jumpahead (doable, but annoying to write).
     //   - I/O
-    //   - Seeding from a seed_seq.
+
+private:
+    static constexpr std::size_t STATE_BITS = 2 * ITYPE_BITS;
+
+    using poly = iu::detail::gf2_poly<STATE_BITS>;
+
+    static const iu::detail::gf2_char_poly<STATE_BITS>& char_poly()
+    {
+        static const iu::detail::gf2_char_poly<STATE_BITS> p(
+            [s0 = itype(0xc1f651c67c62c6e0), s1 = itype(0x30d89576f866ac9f)]()
+            mutable {
+                const bool r = s0 & 1;
+                advance(s0, s1);
+                return r;
+            });
+        return p;
+    }
+
+    void jump(const poly& j)
+    {
+        itype s0 = 0, s1 = 0;
+        for (std::size_t i = 0; i < STATE_BITS; ++i) {
+            if (j.coefficient(i)) {
+                s0 ^= s0_;
+                s1 ^= s1_;
+            }
+            advance();
+        }
+        s0_ = s0;
+        s1_ = s1;
+    }
 };
 
 template <typename itype, typename rtype,
@@ -113,13 +245,29 @@ private:
 public:
     using base::base;
 
+    static inline rtype output(itype s0, itype s1)
+    {
+        return rtype(itype(s0 + s1) >> (base::ITYPE_BITS - base::RTYPE_BITS));
+    }
+
     rtype operator()()
     {
-        const itype result = base::s0_ + base::s1_;
+        const rtype result = output(base::s0_, base::s1_);
 
         base::advance();
 
-        return result >> (base::ITYPE_BITS - base::RTYPE_BITS);
+        return result;
+    }
+
+    void generate(rtype* out, std::size_t n)
+    {
+        base::generate_n(out, n, output);
+    }
+
+    template <typename Container>
+    void generate(Container& values)
+    {
+        generate(std::data(values), std::size(values));
     }
 };
 
@@ -131,13 +279,29 @@ private:
 public:
     using base::base;
 
+    static inline rtype output(itype s0, itype)
+    {
+        return rtype(itype(s0 * mult) >> (base::ITYPE_BITS - base::RTYPE_BITS));
+    }
+
     rtype operator()()
     {
-        const itype result_star = base::s0_ * mult;
+        const rtype result_star = output(base::s0_, base::s1_);
 
         base::advance();
 
-        return result_star >> (base::ITYPE_BITS - base::RTYPE_BITS);
+        return result_star;
+    }
+
+    void generate(rtype* out, std::size_t n)
+    {
+        base::generate_n(out, n, output);
+    }
+
+    template <typename Container>
+    void generate(Container& values)
+    {
+        generate(std::data(values), std::size(values));
     }
 };
 
@@ -150,13 +314,30 @@ private:
 public:
     using base::base;
 
+    static inline rtype output(itype s0, itype)
+    {
+        return rtype(itype(base::rotl(s0 * mult1, orot) * mult2)
+                     >> (base::ITYPE_BITS - base::RTYPE_BITS));
+    }
+
     rtype operator()()
     {
-        const itype result_ss = base::rotl(base::s0_ * mult1, orot) * mult2;
+        const rtype result_ss = output(base::s0_, base::s1_);
 
         base::advance();
 
-        return result_ss >> (base::ITYPE_BITS - base::RTYPE_BITS);
+        return result_ss;
+    }
+
+    void generate(rtype* out, std::size_t n)
+    {
+        base::generate_n(out, n, output);
+    }
+
+    template <typename Container>
+    void generate(Container& values)
+    {
+        generate(std::data(values), std::size(values));
     }
 };
 